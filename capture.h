@@ -0,0 +1,125 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+// the frame is copied into a ring of pixel buffers and each buffer is only mapped
+// CAPTURE_LATENCY frames after its glReadPixels, by then the copy is done and mapping does
+// not stall the render loop. the mapped buffer then stays with the writer thread for up to
+// CAPTURE_SLACK frames before the ring comes back around to it, so a slow write only blocks
+// the render loop once the writer is that far behind
+#define CAPTURE_LATENCY 2
+#define CAPTURE_SLACK 4
+#define CAPTURE_BUFFERS (CAPTURE_LATENCY + CAPTURE_SLACK)
+
+typedef struct Capture
+{
+    File file;
+    Semaphore pending; // counts mapped buffers the writer has not written yet
+    Semaphore written; // counts buffers the writer is done with, in the order they were mapped
+    unsigned int buffers[CAPTURE_BUFFERS];
+    GLsync fences[CAPTURE_BUFFERS];
+    void *mapped[CAPTURE_BUFFERS];
+    int32_t width, height;
+    uint32_t frame;
+} Capture;
+
+static Capture global_capture;
+
+// the writer takes the buffers in the same order they are mapped
+static void capture_writer(void)
+{
+    uint32_t const size = (uint32_t)(global_capture.width * global_capture.height * 4);
+    for (uint32_t slot = 0;; slot = (slot + 1) % CAPTURE_BUFFERS)
+    {
+        wait_semaphore(&global_capture.pending);
+        append_file(global_capture.file, global_capture.mapped[slot], size);
+        signal_semaphore(&global_capture.written);
+    }
+}
+
+// frames are appended to the file as bottom-up bgra at the size given here, returns false
+// when the file can not be created
+static bool create_capture(char const *path, int32_t width, int32_t height)
+{
+    global_capture.width = width;
+    global_capture.height = height;
+    if (!create_file(&global_capture.file, path)) return false;
+    create_semaphore(&global_capture.pending);
+    create_semaphore(&global_capture.written);
+    
+    glGenBuffers(CAPTURE_BUFFERS, global_capture.buffers);
+    for (int32_t i = 0; i < CAPTURE_BUFFERS; ++i)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, global_capture.buffers[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    start_thread(&capture_writer);
+    return true;
+}
+
+// waits for the copy of a frame and hands its buffer to the writer thread
+static void map_capture(Capture *capture, uint32_t frame)
+{
+    uint32_t const slot = frame % CAPTURE_BUFFERS;
+    glClientWaitSync(capture->fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(capture->fences[slot]);
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->buffers[slot]);
+    capture->mapped[slot] = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                             capture->width * capture->height * 4,
+                                             GL_MAP_READ_BIT);
+    signal_semaphore(&capture->pending);
+}
+
+// takes a buffer back from the writer, they come back in the order they were mapped
+static void unmap_capture(Capture *capture, uint32_t slot)
+{
+    wait_semaphore(&capture->written);
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->buffers[slot]);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    capture->mapped[slot] = NULL;
+}
+
+// must be called after drawing into framebuffer and before it is swapped away
+static void capture_frame(unsigned int framebuffer)
+{
+    Capture *const capture = &global_capture;
+    uint32_t const slot = capture->frame % CAPTURE_BUFFERS;
+    
+    // the buffer we are about to reuse may still be with the writer
+    if (capture->mapped[slot]) unmap_capture(capture, slot);
+    
+    // start copying the frame, this returns without waiting for the gpu
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, capture->buffers[slot]);
+    glReadPixels(0, 0, capture->width, capture->height,
+                 GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+    capture->fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    
+    // the copy started CAPTURE_LATENCY frames ago should be done by now
+    if (capture->frame >= CAPTURE_LATENCY) map_capture(capture, capture->frame - CAPTURE_LATENCY);
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    capture->frame += 1;
+}
+
+// writes out the frames that are still being copied or written, call before exiting
+static void finish_capture(void)
+{
+    Capture *const capture = &global_capture;
+    uint32_t const first = capture->frame > CAPTURE_LATENCY ? capture->frame - CAPTURE_LATENCY : 0;
+    for (uint32_t frame = first; frame < capture->frame; ++frame) map_capture(capture, frame);
+    
+    // the oldest buffer the writer holds comes first
+    for (uint32_t i = 0; i < CAPTURE_BUFFERS; ++i)
+    {
+        uint32_t const slot = (capture->frame + i) % CAPTURE_BUFFERS;
+        if (capture->mapped[slot]) unmap_capture(capture, slot);
+    }
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+#endif // CAPTURE_H
@@ -0,0 +1,159 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+// fixed point numbers of up to FIXED_LIMBS 32 bit limbs with a separate sign, for reference
+// orbits deeper than double. the first limb is the integer part and every limb after it
+// holds the next 32 bits of the fraction, the functions take how many of them are in use so
+// shallow views do not pay for the deep ones. they only touch limbs one at a time, a loop
+// that clears or copies a whole number would become a memset or memcpy call which we can
+// not link without the crt
+
+#define FIXED_LIMBS 40 // an integer limb and 1248 bits of fraction, views down to about 1e-359
+
+typedef struct Fixed
+{
+    uint32_t limbs[FIXED_LIMBS]; // the most significant first
+    bool negative;
+} Fixed;
+
+static void fixed_from_floatexp(Fixed *result, FloatExp value, int32_t limbs)
+{
+    // the mantissa is in [1, 2) so its bits are the 52 below the leading one
+    DoubleBits const bits = { .value = value.mantissa };
+    uint64_t const mantissa = value.mantissa != 0.0 ?
+                              (bits.bits & (((uint64_t)1 << 52) - 1)) | (uint64_t)1 << 52 : 0;
+    
+    // the lowest bit of the mantissa has the weight 2^shift, limb i is the mantissa shifted
+    // by 32i more so its own lowest bit lands on bit 0
+    int32_t const shift = value.exponent - 52;
+    for (int32_t i = 0; i < limbs; ++i)
+    {
+        int32_t const s = shift + 32 * i;
+        result->limbs[i] = s >= 32 ? 0 : s >= 0 ? (uint32_t)(mantissa << s) :
+                           s > -64 ? (uint32_t)(mantissa >> -s) : 0;
+    }
+    
+    result->negative = value.mantissa < 0.0;
+}
+
+static void fixed_from_double(Fixed *result, double value, int32_t limbs)
+{
+    fixed_from_floatexp(result, fe_from_double(value), limbs);
+}
+
+static FloatExp fixed_to_floatexp(Fixed const *value, int32_t limbs)
+{
+    // the first limb that is not 0 and the two after it hold more bits than a double
+    int32_t i = 0;
+    while (i < limbs - 1 && value->limbs[i] == 0) ++i;
+    
+    double result = (double)value->limbs[i];
+    if (i + 1 < limbs) result += (double)value->limbs[i + 1] * fe_power(-32);
+    if (i + 2 < limbs) result += (double)value->limbs[i + 2] * fe_power(-64);
+    return fe_normalise(value->negative ? -result : result, -32 * i);
+}
+
+static double fixed_to_double(Fixed const *value, int32_t limbs)
+{
+    return fe_to_double(fixed_to_floatexp(value, limbs));
+}
+
+// clears the bits of value below 2^exponent
+static void fixed_truncate(Fixed *value, int32_t exponent, int32_t limbs)
+{
+    for (int32_t i = 0; i < limbs; ++i)
+    {
+        // bit b of limb i has the weight 2^(b - 32i)
+        int32_t const s = exponent + 32 * i;
+        value->limbs[i] &= s <= 0 ? 0xFFFFFFFF : s >= 32 ? 0 : 0xFFFFFFFF << s;
+    }
+}
+
+// result = a + b, or a - b when subtract is set. result may be a or b
+static void fixed_add(Fixed *result, Fixed const *a, Fixed const *b, bool subtract, int32_t limbs)
+{
+    bool const a_negative = a->negative;
+    bool const b_negative = b->negative != subtract;
+    if (a_negative == b_negative)
+    {
+        uint32_t carry = 0;
+        for (int32_t i = limbs - 1; i >= 0; --i)
+        {
+            uint64_t const sum = (uint64_t)a->limbs[i] + b->limbs[i] + carry;
+            result->limbs[i] = (uint32_t)sum;
+            carry = (uint32_t)(sum >> 32);
+        }
+        
+        result->negative = a_negative;
+        return;
+    }
+    
+    // with different signs the smaller magnitude is taken from the larger one
+    int32_t first = 0;
+    while (first < limbs - 1 && a->limbs[first] == b->limbs[first]) ++first;
+    bool const swap = a->limbs[first] < b->limbs[first];
+    Fixed const *const larger = swap ? b : a;
+    Fixed const *const smaller = swap ? a : b;
+    
+    uint32_t borrow = 0;
+    for (int32_t i = limbs - 1; i >= 0; --i)
+    {
+        uint64_t const difference = (uint64_t)larger->limbs[i] - smaller->limbs[i] - borrow;
+        result->limbs[i] = (uint32_t)difference;
+        borrow = (uint32_t)(difference >> 63);
+    }
+    
+    result->negative = swap ? b_negative : a_negative;
+}
+
+// results[n] = values[n]^2 for the three squares of an orbit step, truncated to the limbs in
+// use. the product of limbs i and j lands in column i + j, and every column is summed on its
+// own from the lowest one up: the products of two different limbs appear twice in a square
+// so they are summed once and doubled, which takes about half the multiplies of a general
+// product. the columns past the last limb are dropped except for one that rounds it, and
+// writing column k only after every column above it is summed means results[n] may be
+// values[n]. the three squares do not depend on each other so they share one pass, where
+// their multiplies overlap instead of each waiting on its own sums
+static void fixed_square_3(Fixed *const results[3], Fixed const *const values[3], int32_t limbs)
+{
+    uint32_t const *const x = values[0]->limbs;
+    uint32_t const *const y = values[1]->limbs;
+    uint32_t const *const w = values[2]->limbs;
+    uint64_t carry[3] = { 0, 0, 0 };
+    uint64_t pending[3] = { 0, 0, 0 }; // the high halves of the column before
+    for (int32_t k = limbs; k >= 0; --k)
+    {
+        // the halves are summed apart so a column of up to FIXED_LIMBS products can not overflow
+        uint64_t low[3] = { 0, 0, 0 }, high[3] = { 0, 0, 0 };
+        int32_t i = k < limbs ? 0 : k - limbs + 1;
+        for (; i < k - i; ++i)
+        {
+            uint64_t const px = (uint64_t)x[i] * x[k - i];
+            uint64_t const py = (uint64_t)y[i] * y[k - i];
+            uint64_t const pw = (uint64_t)w[i] * w[k - i];
+            low[0] += (uint32_t)px;
+            low[1] += (uint32_t)py;
+            low[2] += (uint32_t)pw;
+            high[0] += px >> 32;
+            high[1] += py >> 32;
+            high[2] += pw >> 32;
+        }
+        
+        uint64_t const square[3] = {
+            i == k - i ? (uint64_t)x[i] * x[i] : 0,
+            i == k - i ? (uint64_t)y[i] * y[i] : 0,
+            i == k - i ? (uint64_t)w[i] * w[i] : 0,
+        };
+        for (int32_t n = 0; n < 3; ++n)
+        {
+            uint64_t const sum = (low[n] << 1) + (uint32_t)square[n] + pending[n] + carry[n];
+            if (k < limbs) results[n]->limbs[k] = (uint32_t)sum;
+            carry[n] = sum >> 32;
+            pending[n] = (high[n] << 1) + (square[n] >> 32);
+        }
+    }
+    
+    for (int32_t n = 0; n < 3; ++n) results[n]->negative = false;
+}
+
+#endif // FIXED_H
@@ -0,0 +1,109 @@
+#ifndef FLOATEXP_H
+#define FLOATEXP_H
+
+// a double mantissa with its own exponent, for values that leave the range of double (or
+// float once they are handed to the shaders) on very deep zooms. it works on the bits of
+// the double so it needs neither libm nor the crt
+
+typedef struct FloatExp
+{
+    double mantissa; // 0 or in [1, 2) by magnitude
+    int32_t exponent;
+} FloatExp;
+
+typedef union DoubleBits
+{
+    double value;
+    uint64_t bits;
+} DoubleBits;
+
+// 2^exponent for the exponents a normal double can hold
+static double fe_power(int32_t exponent)
+{
+    DoubleBits const power = { .bits = (uint64_t)(exponent + 1023) << 52 };
+    return power.value;
+}
+
+// value * 2^exponent, in steps so the factor itself never leaves the range of double
+static double fe_ldexp(double value, int32_t exponent)
+{
+    for (; exponent > 1000; exponent -= 1000) value *= fe_power(1000);
+    for (; exponent < -1000; exponent += 1000) value *= fe_power(-1000);
+    return value * fe_power(exponent);
+}
+
+static FloatExp fe_from_double(double value)
+{
+    if (value == 0.0) return (FloatExp){ 0.0, 0 };
+    
+    DoubleBits bits = { .value = value };
+    int32_t exponent = (int32_t)((bits.bits >> 52) & 0x7FF);
+    
+    // denormals are scaled up first so their leading bit lands in the exponent field
+    int32_t offset = 0;
+    if (exponent == 0)
+    {
+        bits.value = value * fe_power(64);
+        exponent = (int32_t)((bits.bits >> 52) & 0x7FF);
+        offset = 64;
+    }
+    
+    bits.bits = (bits.bits & ~((uint64_t)0x7FF << 52)) | ((uint64_t)1023 << 52);
+    return (FloatExp){ bits.value, exponent - 1023 - offset };
+}
+
+static double fe_to_double(FloatExp value)
+{
+    return fe_ldexp(value.mantissa, value.exponent);
+}
+
+static FloatExp fe_normalise(double mantissa, int32_t exponent)
+{
+    FloatExp result = fe_from_double(mantissa);
+    if (result.mantissa != 0.0) result.exponent += exponent;
+    return result;
+}
+
+static FloatExp fe_mul(FloatExp a, FloatExp b)
+{
+    return fe_normalise(a.mantissa * b.mantissa, a.exponent + b.exponent);
+}
+
+static FloatExp fe_add(FloatExp a, FloatExp b)
+{
+    if (b.mantissa == 0.0) return a;
+    if (a.mantissa == 0.0) return b;
+    if (a.exponent < b.exponent)
+    {
+        FloatExp const swap = a;
+        a = b;
+        b = swap;
+    }
+    
+    // the smaller one is below the precision of the mantissa past 64 bits
+    int32_t const shift = b.exponent - a.exponent;
+    if (shift < -64) return a;
+    return fe_normalise(a.mantissa + b.mantissa * fe_power(shift), a.exponent);
+}
+
+static FloatExp fe_sub(FloatExp a, FloatExp b)
+{
+    b.mantissa = -b.mantissa;
+    return fe_add(a, b);
+}
+
+static bool fe_equal(FloatExp a, FloatExp b)
+{
+    return a.mantissa == b.mantissa && (a.exponent == b.exponent || a.mantissa == 0.0);
+}
+
+// |a| < |b|, the mantissas of both are in [1, 2) so the exponents decide unless they match
+static bool fe_smaller(FloatExp a, FloatExp b)
+{
+    if (b.mantissa == 0.0) return false;
+    if (a.mantissa == 0.0) return true;
+    if (a.exponent != b.exponent) return a.exponent < b.exponent;
+    return (a.mantissa < 0.0 ? -a.mantissa : a.mantissa) < (b.mantissa < 0.0 ? -b.mantissa : b.mantissa);
+}
+
+#endif // FLOATEXP_H
@@ -0,0 +1,489 @@
+// headless build: renders the same shaders into an offscreen framebuffer through a
+// surfaceless egl context. on machines without a gpu mesa runs them on llvmpipe,
+// which makes this usable on render nodes and for benchmarking shader changes in ci
+//
+// usage: headless [-s width height] [-n frames] [-i max_iterations] [-o output.ppm] [-t budget_ms]
+//                 [-x pos_x] [-y pos_y] [-z scale]
+//                 [-f formula] [-b bailout] [-p precision] [-c coloring] [-u unroll] [-k kernel]
+//                 [-r runs] [-m zoom] [-w capture.raw] [-d cold]
+// the variant options take the index of the enum value in renderer.h, -p a picks the precision
+// from the view like the windowed build does. -x and -y are read to every digit they have and
+// -z may go past what a double holds, e.g. -z 1e-315. -r times the reference orbit of the view instead
+// of drawing it, -m multiplies the scale by zoom after every frame and -w appends every frame
+// to a file through the same pixel buffer ring as the windowed capture. a view that is done is
+// only recoloured by the following frames, -d 1 throws it away before every frame so each one
+// iterates a whole round and ms/frame measures the shader
+
+// standard headers
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// opengl headers
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "platform.h"
+#include "opengl.h"
+#include "floatexp.h"
+#include "fixed.h"
+#include "renderer.h"
+
+#ifdef CAPTURE_MODE
+#include "capture.h"
+#endif
+
+#ifdef PROFILE_MODE
+#include "profile.h"
+#endif
+
+static EGLDisplay display;
+static EGLContext compile_context;
+
+static bool make_compile_context_current_egl(void)
+{
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, compile_context);
+}
+
+static bool create_headless_context(void)
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC const eglGetPlatformDisplayEXT = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+        eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!eglGetPlatformDisplayEXT) return false;
+    
+    // the surfaceless platform needs neither a window system nor a gpu
+    display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA,
+                                       EGL_DEFAULT_DISPLAY, NULL);
+    if (!eglInitialize(display, NULL, NULL)) return false;
+    
+    // like wglCreateContext this gives us the newest compatibility context
+    eglBindAPI(EGL_OPENGL_API);
+    EGLContext const context = eglCreateContext(display, EGL_NO_CONFIG_KHR, 
+                                                EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT) return false;
+    
+    // a second context sharing objects with the first one so shader variants
+    // can be compiled on another thread
+    compile_context = eglCreateContext(display, EGL_NO_CONFIG_KHR, context, NULL);
+    if (compile_context != EGL_NO_CONTEXT)
+    {
+        make_compile_context_current = &make_compile_context_current_egl;
+    }
+    
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+}
+
+// there is no default framebuffer without a surface so the renderer copies its image into our own
+static unsigned int create_framebuffer(int32_t width, int32_t height)
+{
+    unsigned int framebuffer, renderbuffer;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 
+                              GL_RENDERBUFFER, renderbuffer);
+    
+    return framebuffer;
+}
+
+static bool write_ppm(char const *path, unsigned int framebuffer, int32_t width, int32_t height)
+{
+    uint8_t *const pixels = malloc((size_t)width * (size_t)height * 3);
+    FILE *const file = fopen(path, "wb");
+    if (!pixels || !file) return false;
+    
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    
+    // opengl rows start at the bottom, ppm rows at the top
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    for (int32_t y = height - 1; y >= 0; --y)
+    {
+        fwrite(pixels + (size_t)y * (size_t)width * 3, 3, (size_t)width, file);
+    }
+    
+    free(pixels);
+    return fclose(file) == 0;
+}
+
+static void usage(char const *name)
+{
+    fprintf(stderr, "usage: %s [-s width height] [-n frames] [-i max_iterations] [-o output.ppm] [-t budget_ms]\n"
+            "       [-x pos_x] [-y pos_y] [-z scale]\n"
+            "       [-f formula] [-b bailout] [-p precision] [-c coloring] [-u unroll] [-k kernel]\n"
+            "       [-r runs] [-m zoom] [-w capture.raw] [-d cold]\n", name);
+}
+
+// a decimal like -0.74364388703715870475219150611 read to every digit it has, where atof
+// stops at double. returns false for anything else, e.g. one with an exponent
+static bool parse_fixed(Fixed *result, char const *text)
+{
+    result->negative = *text == '-';
+    if (*text == '-' || *text == '+') ++text;
+    
+    uint32_t integer = 0;
+    for (; *text >= '0' && *text <= '9'; ++text) integer = integer * 10 + (uint32_t)(*text - '0');
+    
+    char const *const fraction = *text == '.' ? text + 1 : text;
+    char const *end = fraction;
+    while (*end >= '0' && *end <= '9') ++end;
+    if (*end != '\0') return false;
+    
+    // the fraction is built from its last digit up, each digit is put in front of it and the
+    // whole is divided by 10
+    for (int32_t i = 0; i < FIXED_LIMBS; ++i) result->limbs[i] = 0;
+    for (char const *digit = end; digit > fraction; --digit)
+    {
+        uint64_t remainder = (uint64_t)(digit[-1] - '0');
+        for (int32_t i = 1; i < FIXED_LIMBS; ++i)
+        {
+            uint64_t const value = remainder << 32 | result->limbs[i];
+            result->limbs[i] = (uint32_t)(value / 10);
+            remainder = value % 10;
+        }
+    }
+    
+    result->limbs[0] = integer;
+    return true;
+}
+
+// 10^exponent by squaring, good to about 1e-15
+static FloatExp fe_pow10(int32_t exponent)
+{
+    FloatExp result = fe_from_double(1.0);
+    FloatExp base = fe_from_double(exponent < 0 ? 0.1 : 10.0);
+    for (uint32_t n = exponent < 0 ? -(uint32_t)exponent : (uint32_t)exponent; n != 0; n >>= 1)
+    {
+        if (n & 1) result = fe_mul(result, base);
+        base = fe_mul(base, base);
+    }
+    
+    return result;
+}
+
+// a scale like 1e-400 that double can not hold, the mantissa and the exponent are read apart
+static FloatExp parse_floatexp(char const *text)
+{
+    char const *const e = strpbrk(text, "eE");
+    if (!e) return fe_from_double(atof(text));
+    
+    char mantissa[64];
+    snprintf(mantissa, sizeof(mantissa), "%.*s", (int)(e - text), text);
+    return fe_mul(fe_from_double(atof(mantissa)), fe_pow10(atoi(e + 1)));
+}
+
+// the decimal form of a floatexp, for scales printf can not show
+static void format_floatexp(char *buffer, size_t size, FloatExp value)
+{
+    // log10(2) puts the decimal exponent within one of the right one
+    int32_t exponent = (int32_t)((double)value.exponent * 0.30102999566398);
+    double mantissa = fe_to_double(fe_mul(value, fe_pow10(-exponent)));
+    for (; mantissa >= 10.0 || mantissa <= -10.0; ++exponent) mantissa /= 10.0;
+    for (; mantissa != 0.0 && mantissa < 1.0 && mantissa > -1.0; --exponent) mantissa *= 10.0;
+    snprintf(buffer, size, "%.6ge%d", mantissa, exponent);
+}
+
+// the generic baseline for -r: a schoolbook product of every pair of limbs into a result
+// twice as long, and z^2 from the three products x*x, y*y and x*y
+static void schoolbook_mul(Fixed *result, Fixed const *a, Fixed const *b, int32_t limbs)
+{
+    // product[k + 1] has the weight of limb k, product[0] is what overflows the integer limb
+    uint32_t product[FIXED_LIMBS * 2 + 1] = {0};
+    for (int32_t i = limbs - 1; i >= 0; --i)
+    {
+        uint64_t carry = 0;
+        for (int32_t j = limbs - 1; j >= 0; --j)
+        {
+            uint64_t const sum = (uint64_t)a->limbs[i] * b->limbs[j] + product[i + j + 1] + carry;
+            product[i + j + 1] = (uint32_t)sum;
+            carry = sum >> 32;
+        }
+        product[i] = (uint32_t)carry;
+    }
+    
+    for (int32_t k = 0; k < limbs; ++k) result->limbs[k] = product[k + 1];
+    result->negative = a->negative != b->negative;
+}
+
+static void schoolbook_step(Fixed z[2], Fixed const pos[2], Formula formula, int32_t limbs)
+{
+    static Fixed xx, yy, xy;
+    schoolbook_mul(&xx, &z[0], &z[0], limbs);
+    schoolbook_mul(&yy, &z[1], &z[1], limbs);
+    schoolbook_mul(&xy, &z[0], &z[1], limbs);
+    if (formula == FORMULA_BURNING_SHIP) xy.negative = false;
+    if (formula == FORMULA_TRICORN) xy.negative = !xy.negative;
+    
+    fixed_add(&z[0], &xx, &yy, true, limbs);
+    fixed_add(&z[0], &z[0], &pos[0], true, limbs);
+    fixed_add(&z[1], &xy, &xy, false, limbs);
+    fixed_add(&z[1], &z[1], &pos[1], true, limbs);
+}
+
+// iterates the reference orbit of the frame with both steps and reports the time per orbit
+// and how far apart the two orbits ended up, in units of the scale
+static void benchmark_reference(Frame const *frame, Formula formula, int32_t runs)
+{
+    int32_t const limbs = reference_limbs(frame->scale);
+    static Fixed pos[2], z[2];
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        fixed_from_floatexp(&pos[i], frame->offset[i], limbs);
+        fixed_add(&pos[i], &frame->anchor[i], &pos[i], false, limbs);
+    }
+    
+    static float orbits[2][REFERENCE_CAPACITY * 2];
+    double times[2];
+    int32_t length = 0;
+    for (int32_t method = 0; method < 2; ++method)
+    {
+        double const start = seconds();
+        for (int32_t run = 0; run < runs; ++run)
+        {
+            fixed_from_double(&z[0], 0.0, limbs);
+            fixed_from_double(&z[1], 0.0, limbs);
+            for (length = 1; length <= frame->max_iterations && length < REFERENCE_CAPACITY; ++length)
+            {
+                if (method == 0) reference_step(z, pos, formula, limbs);
+                else schoolbook_step(z, pos, formula, limbs);
+                
+                double const x = fixed_to_double(&z[0], limbs);
+                double const y = fixed_to_double(&z[1], limbs);
+                orbits[method][length * 2] = (float)x;
+                orbits[method][length * 2 + 1] = (float)y;
+                if (x * x + y * y >= REFERENCE_BAILOUT) break;
+            }
+        }
+        times[method] = (seconds() - start) / runs;
+    }
+    
+    double difference = 0.0;
+    for (int32_t i = 2; i < length * 2; ++i)
+    {
+        double const d = (double)orbits[0][i] - (double)orbits[1][i];
+        if (d > difference || -d > difference) difference = d > 0.0 ? d : -d;
+    }
+    
+    printf("reference orbit of %d points at %d limbs: squaring %.3f ms, schoolbook %.3f ms, "
+           "apart by %g of the scale\n", length, limbs, times[0] * 1e3, times[1] * 1e3,
+           fe_ldexp(difference / frame->scale.mantissa, -frame->scale.exponent));
+}
+
+int main(int argc, char **argv)
+{
+    int32_t width = 800, height = 600;
+    int32_t frames = 100;
+    int32_t max_iterations = 200;
+    char const *output = NULL;
+    double time_budget = 1e9; // whole frames unless asked otherwise
+    static Fixed anchor[2];
+    FloatExp scale = fe_from_double(1.0);
+    Variant variant = {0};
+    int32_t reference_runs = 0;
+    bool automatic_precision = false;
+    double zoom = 1.0;
+    bool cold = false;
+#ifdef CAPTURE_MODE
+    char const *capture = NULL;
+#endif
+    
+    // options and their values alternate, e.g. -n 100 -i 500
+    for (int32_t i = 1; i < argc; i += 2)
+    {
+        if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        
+        char const *const value = argv[i + 1];
+        switch (argv[i][1])
+        {
+            case 's':
+            {
+                if (i + 2 >= argc) { usage(argv[0]); return 1; }
+                width = atoi(value);
+                height = atoi(argv[++i + 1]);
+            } break;
+            
+            case 'n': frames = atoi(value); break;
+            case 'i': max_iterations = atoi(value); break;
+            case 'o': output = value; break;
+            case 't': time_budget = atof(value) * 1e-3; break;
+            case 'x':
+            case 'y':
+            {
+                Fixed *const pos = &anchor[argv[i][1] - 'x'];
+                if (!parse_fixed(pos, value)) fixed_from_double(pos, atof(value), FIXED_LIMBS);
+            } break;
+            
+            case 'z': scale = parse_floatexp(value); break;
+            case 'f': variant.formula = (Formula)(atoi(value) % FORMULA_LENGTH); break;
+            case 'b': variant.bailout = (Bailout)(atoi(value) % BAILOUT_LENGTH); break;
+            case 'c': variant.coloring = (Coloring)(atoi(value) % COLORING_LENGTH); break;
+            case 'u': variant.unroll = (Unroll)(atoi(value) % UNROLL_LENGTH); break;
+            case 'k': variant.kernel = (Kernel)(atoi(value) % KERNEL_LENGTH); break;
+            case 'r': reference_runs = atoi(value); break;
+            case 'm': zoom = atof(value); break;
+            case 'd': cold = atoi(value) != 0; break;
+#ifdef CAPTURE_MODE
+            case 'w': capture = value; break;
+#endif
+            
+            case 'p':
+            {
+                automatic_precision = value[0] == 'a';
+                variant.precision = (Precision)(atoi(value) % PRECISION_LENGTH);
+            } break;
+            
+            default:
+            {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+    }
+    
+    if (width <= 0 || height <= 0 || frames <= 0 || max_iterations <= 0 || time_budget <= 0.0 ||
+        scale.mantissa <= 0.0 || zoom <= 0.0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    
+    // by default the same starting view as the windowed build once the smoothing has settled
+    Frame frame = {
+        .width = width,
+        .height = height,
+        .aspect_ratio = (float)width / (float)height,
+        .scale = scale,
+        .anchor = anchor,
+        .max_iterations = max_iterations,
+    };
+    
+    if (reference_runs > 0)
+    {
+        benchmark_reference(&frame, variant.formula, reference_runs);
+        return 0;
+    }
+    
+    if (!create_headless_context())
+    {
+        fprintf(stderr, "could not create a surfaceless egl context\n");
+        return 1;
+    }
+    
+    // load opengl extensions after creating an opengl context
+    load_extensions();
+    unsigned int const framebuffer = create_framebuffer(width, height);
+    
+    // start from the default variant and request the chosen one, like the windowed build
+    // does when a key is pressed, so it goes through the compile thread
+    Renderer renderer;
+    create_renderer(&renderer, (Variant){0});
+    renderer.output_framebuffer = framebuffer;
+    renderer.time_budget = time_budget;
+    if (automatic_precision) variant.precision = pick_precision(&renderer, &frame);
+    renderer.requested_variant = variant;
+    while (variant_index(renderer.variant) != variant_index(variant))
+    {
+        update_variant(&renderer);
+        if (variant_index(renderer.requested_variant) != variant_index(variant))
+        {
+            fprintf(stderr, "the requested shader variant failed to compile\n");
+            return 1;
+        }
+    }
+    
+    // from here on the precision can change with the zoom, each change is reported
+    renderer.automatic_precision = automatic_precision;
+    Precision precision = PRECISION_LENGTH;
+    
+    printf("%s | %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    fflush(stdout); // the profile report is written around stdio
+    
+#ifdef CAPTURE_MODE
+    if (capture && !create_capture(capture, width, height))
+    {
+        fprintf(stderr, "could not create %s\n", capture);
+        return 1;
+    }
+#endif
+    
+#ifdef PROFILE_MODE
+    Profile profile = {0};
+    create_profile(&profile);
+#endif
+    
+    double const start = seconds();
+    for (int32_t i = 0; i < frames; ++i)
+    {
+        // only between rounds, a round spread over several frames still finishes
+        if (cold && !renderer.iterating) renderer.has_complete_state = false;
+        
+#ifdef PROFILE_MODE
+        profile_gpu_begin(&profile);
+#endif
+        draw_frame(&renderer, &frame);
+#ifdef PROFILE_MODE
+        profile_gpu_end();
+        profile_phase(&profile, PHASE_DRAW);
+        profile_precision(&profile, renderer.variant.precision);
+#endif
+        
+#ifdef CAPTURE_MODE
+        // the windowed build captures right before the swap so it is timed with it
+        if (capture)
+        {
+            capture_frame(framebuffer);
+#ifdef PROFILE_MODE
+            profile_phase(&profile, PHASE_SWAP);
+#endif
+        }
+#endif
+        
+#ifdef PROFILE_MODE
+        profile_end_frame(&profile);
+#endif
+        
+        if (renderer.variant.precision != precision)
+        {
+            precision = renderer.variant.precision;
+            char scale_text[32];
+            format_floatexp(scale_text, sizeof(scale_text), frame.scale);
+            printf("frame %d at scale %s drawn as %s\n", i, scale_text, precision_names[precision]);
+            fflush(stdout);
+        }
+        
+        frame.color_offset += 0.001f;
+        frame.scale = fe_mul(frame.scale, fe_from_double(zoom));
+    }
+#ifdef CAPTURE_MODE
+    if (capture) finish_capture();
+#endif
+    glFinish();
+    double const elapsed = seconds() - start;
+    finish_saving();
+    
+#ifdef PROFILE_MODE
+    if (profile.frame_count % PROFILE_SAMPLES != 0) profile_report(&profile);
+#endif
+    
+    printf("%d frames of %dx%d at %d iterations: %.3f ms/frame\n", frames, 
+           width, height, max_iterations, elapsed * 1e3 / frames);
+    
+    if (output && !write_ppm(output, framebuffer, width, height))
+    {
+        fprintf(stderr, "could not write %s\n", output);
+        return 1;
+    }
+    
+    return 0;
+}
@@ -12,7 +12,19 @@
 #include <gl/GL.h>
 #include "glext.h"
 #include "wglext.h"
+#include "platform.h"
 #include "opengl.h"
+#include "floatexp.h"
+#include "fixed.h"
+#include "renderer.h"
+
+#ifdef CAPTURE_MODE
+#include "capture.h"
+#endif
+
+#ifdef PROFILE_MODE
+#include "profile.h"
+#endif
 
 // needed when we use floats
 extern int _fltused;
@@ -21,9 +33,11 @@ int _fltused;
 typedef struct Window
 {
     HDC device_context;
+    int32_t width, height;
     float aspect_ratio;
-    float scale, pos[2];
-    float smooth_scale, smooth_pos[2];
+    FloatExp scale, offset[2]; // the view is at anchor + offset, see Frame
+    FloatExp smooth_scale, smooth_offset[2];
+    Fixed anchor[2];
     int32_t max_iterations;
 } Window;
 
@@ -42,6 +56,12 @@ typedef enum Keys
     KEY_DOWN = VK_DOWN,
     KEY_R = 'R',
     KEY_CTRL = VK_CONTROL,
+    KEY_F = 'F',
+    KEY_B = 'B',
+    KEY_P = 'P',
+    KEY_C = 'C',
+    KEY_U = 'U',
+    KEY_K = 'K',
     KEY_LENGTH // needed to keep track of number of keys
 } Keys;
 
@@ -49,6 +69,24 @@ typedef enum Keys
 // however this is much more easier
 static Window global_window;
 static bool keys[256];
+static bool pressed[256]; // keys that went down since the last frame
+static HGLRC compile_context;
+
+#ifdef CAPTURE_MODE
+// false when capture.raw could not be created, the window then runs without capturing
+static bool capturing;
+#endif
+
+// the frames still being copied or written go to the capture, and an orbit still being
+// written to its file is finished, before the process ends
+static __declspec(noreturn) void quit(void)
+{
+    finish_saving();
+#ifdef CAPTURE_MODE
+    if (capturing) finish_capture();
+#endif
+    ExitProcess(0);
+}
 
 static LRESULT CALLBACK WinProc(HWND window_handle, UINT message, WPARAM wParam, LPARAM lParam)
 {
@@ -66,17 +104,17 @@ static LRESULT CALLBACK WinProc(HWND window_handle, UINT message, WPARAM wParam,
             LPARAM const width = lParam & 0xFFFF;
             LPARAM const height = (lParam >> 16) & 0xFFFF;
             
-            // store the aspect ratio
+            // store the size and aspect ratio
+            global_window.width = (int32_t)width;
+            global_window.height = (int32_t)height;
             global_window.aspect_ratio = (float)width / (float)height;
-            
-            glViewport(0, 0, width, height);
         } break;
         
         case WM_QUIT:
         case WM_CLOSE:
         case WM_DESTROY:
         {
-            ExitProcess(0);
+            quit();
         }
         
         case WM_KEYUP:
@@ -87,9 +125,10 @@ static LRESULT CALLBACK WinProc(HWND window_handle, UINT message, WPARAM wParam,
             if (should_flip)
             {
                 keys[wParam] = !keys[wParam];
+                pressed[wParam] = keys[wParam];
             }
             
-            if (wParam == VK_ESCAPE) ExitProcess(0);
+            if (wParam == VK_ESCAPE) quit();
         } break;
         
         default:
@@ -101,6 +140,11 @@ static LRESULT CALLBACK WinProc(HWND window_handle, UINT message, WPARAM wParam,
     return 0;
 }
 
+static bool make_compile_context_current_wgl(void)
+{
+    return wglMakeCurrent(global_window.device_context, compile_context);
+}
+
 static void create_opengl_context(HDC const device_context)
 {
     // same as: 
@@ -120,6 +164,14 @@ static void create_opengl_context(HDC const device_context)
     // make the new opengl context current and active
     wglMakeCurrent(device_context, opengl_context);
     
+    // a second context sharing objects with the first one so shader variants
+    // can be compiled on another thread
+    compile_context = wglCreateContext(device_context);
+    if (compile_context && wglShareLists(opengl_context, compile_context))
+    {
+        make_compile_context_current = &make_compile_context_current_wgl;
+    }
+    
     PFNWGLSWAPINTERVALEXTPROC wglSwapIntervalEXT = (PFNWGLSWAPINTERVALEXTPROC)
         wglGetProcAddress("wglSwapIntervalEXT");
     wglSwapIntervalEXT(0);
@@ -156,9 +208,11 @@ static void create_window(int32_t width, int32_t height)
     // setup global window
     {
         global_window.device_context = device_context;
+        global_window.width = width;
+        global_window.height = height;
         global_window.aspect_ratio = (float)width / (float)height;
-        global_window.scale = 1.0f;
-        global_window.smooth_scale = 0.5f;
+        global_window.scale = fe_from_double(1.0);
+        global_window.smooth_scale = fe_from_double(0.5);
         global_window.max_iterations = 200;
     }
     
@@ -166,74 +220,47 @@ static void create_window(int32_t width, int32_t height)
     ShowWindow(window_handle, SW_SHOWDEFAULT);
 }
 
-static unsigned int compile_shaders(char const *vertex_shader_source,
-                                    char const *fragment_shader_source)
+static FloatExp lerp(FloatExp v0, FloatExp v1, double t)
 {
-    // compile vertex shader
-    unsigned int vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &vertex_shader_source, NULL);
-    glCompileShader(vertex_shader);
-    
-    // compile fragment shader
-    unsigned int fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &fragment_shader_source,  NULL);
-    glCompileShader(fragment_shader);
-    
-    // only needed for debugging
-#ifdef DEBUG_MODE
-    {
-        int success;
-        char info_log[512];
-        glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
-        
-        if(success == GL_FALSE)
-        {
-            glGetShaderInfoLog(fragment_shader, sizeof(info_log), 
-                               NULL, info_log);
-            WriteFile((HANDLE)(STD_OUTPUT_HANDLE),
-                      info_log, (DWORD)lstrlenA(info_log),
-                      NULL, NULL);
-        }
-    }
-#endif
-    
-    // link the shaders
-    unsigned int shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader); 
-    glAttachShader(shader_program, fragment_shader); 
-    glLinkProgram(shader_program);
-    
-    return shader_program;
+    return fe_add(v0, fe_mul(fe_sub(v1, v0), fe_from_double(t)));
 }
 
-static float lerp(float v0, float v1, float t)
+// moves the smooth offset into the anchor once it is a scale or more away, so the offsets
+// stay within a few scales and still place the view to a fraction of a pixel at any depth
+static void rebase_view(void)
 {
-    return (1.0f - t) * v0 + t * v1;
+    static Fixed shift;
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        FloatExp const offset = global_window.smooth_offset[i];
+        if (fe_smaller(offset, global_window.smooth_scale)) continue;
+        
+        fixed_from_floatexp(&shift, offset, FIXED_LIMBS);
+        fixed_add(&global_window.anchor[i], &global_window.anchor[i], &shift, false, FIXED_LIMBS);
+        global_window.offset[i] = fe_sub(global_window.offset[i], offset);
+        global_window.smooth_offset[i] = fe_from_double(0.0);
+    }
 }
 
 __declspec(noreturn) void __stdcall entry(void)
 {
     create_window(800, 600);
     
-    // by making this smaller we can save space at the cost of readabilty
-#define VERTEX_SHADER                                                                         \
-"#version 330\n"                                                                          \
-"out vec2 u;void main(){u=vec2[](vec2(0),vec2(1,0),vec2(0,1),vec2(1))[gl_VertexID];"      \
-"gl_Position=vec4(vec2[](vec2(-1,-1),vec2(1,-1),vec2(-1,1),vec2(1))[gl_VertexID],0,1);}"  \
+#ifdef CAPTURE_MODE
+    capturing = create_capture("capture.raw", global_window.width, global_window.height);
+#endif
     
-#define FRAGMENT_SHADER                                                     \
-"#version 330\n"                                                        \
-"#define B 200000.0\n"                                                  \
-"out vec4 F;in vec2 u;uniform int I;uniform float A;uniform vec4 D;"    \
-"void main(){vec2 c=((u*2-1)*vec2(A,1)*D.y-D.zw);vec2 z=vec2(0);int i;" \
-"for(i=0;i<I&&dot(z,z)<B;++i)z=vec2(z.x*z.x-z.y*z.y,z.x*z.y*2)+c;"      \
-"float s=sqrt((i-log2(log(dot(z,z))/log(B)))/float(I));"                \
-"F=(sin(D.x+20*s*vec4(1.5,1.8,2.1,0))*0.5+0.5)*float(i!=I);}"           \
+    Renderer renderer;
+    create_renderer(&renderer, (Variant){0});
+    renderer.automatic_precision = true;
     
-    unsigned int const shader_program = compile_shaders(VERTEX_SHADER, 
-                                                        FRAGMENT_SHADER);
+#ifdef PROFILE_MODE
+    // static, zeroing several kb on the stack would be a memset call
+    static Profile profile;
+    create_profile(&profile);
+    bool drew_frame = false;
+#endif
     
-    glUseProgram(shader_program);
     float color_offset = 0.0f;
     MSG msg;
     for(;;)
@@ -247,29 +274,53 @@ __declspec(noreturn) void __stdcall entry(void)
         
         else
         {
-            // pass uniforms
-            glUniform1f(glGetUniformLocation(shader_program, "A"),
-                        global_window.aspect_ratio);
-            glUniform4f(glGetUniformLocation(shader_program, "D"), color_offset, global_window.smooth_scale, 
-                        global_window.smooth_pos[0], global_window.smooth_pos[1]);
-            glUniform1i(glGetUniformLocation(shader_program, "I"),
-                        global_window.max_iterations);
+            Frame const frame = {
+                .width = global_window.width,
+                .height = global_window.height,
+                .aspect_ratio = global_window.aspect_ratio,
+                .color_offset = color_offset,
+                .scale = global_window.smooth_scale,
+                .anchor = global_window.anchor,
+                .offset = { global_window.smooth_offset[0], global_window.smooth_offset[1] },
+                .max_iterations = global_window.max_iterations,
+            };
             
-            // draw a quad
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+#ifdef PROFILE_MODE
+            profile_phase(&profile, PHASE_EVENTS);
+            profile_gpu_begin(&profile);
+#endif
+            
+            draw_frame(&renderer, &frame);
+            
+#ifdef PROFILE_MODE
+            profile_gpu_end();
+            profile_phase(&profile, PHASE_DRAW);
+            profile_precision(&profile, renderer.variant.precision);
+#endif
+            
+#ifdef CAPTURE_MODE
+            // read the frame back before the back buffer is swapped away
+            if (capturing) capture_frame(0);
+#endif
             
             // finally draw to the screen
             SwapBuffers(global_window.device_context);
             
+#ifdef PROFILE_MODE
+            profile_phase(&profile, PHASE_SWAP);
+            drew_frame = true;
+#endif
+            
             // the smooth values will smoothly converge to the real values
             {
-                global_window.smooth_pos[0] = lerp(global_window.smooth_pos[0], 
-                                                   global_window.pos[0], 0.005f);
-                global_window.smooth_pos[1] = lerp(global_window.smooth_pos[1], 
-                                                   global_window.pos[1], 0.005f);
+                global_window.smooth_offset[0] = lerp(global_window.smooth_offset[0], 
+                                                      global_window.offset[0], 0.005);
+                global_window.smooth_offset[1] = lerp(global_window.smooth_offset[1], 
+                                                      global_window.offset[1], 0.005);
                 
                 global_window.smooth_scale = lerp(global_window.smooth_scale,
-                                                  global_window.scale, 0.005f);
+                                                  global_window.scale, 0.005);
+                rebase_view();
             }
             
             color_offset += 0.001f;
@@ -277,43 +328,50 @@ __declspec(noreturn) void __stdcall entry(void)
         
         // handle input
         {
+            FloatExp const step = fe_mul(global_window.scale, fe_from_double(0.003));
+            
             // some keyboards have two plus keys(number row and numpad)
             if (keys[KEY_PLUS1] || keys[KEY_PLUS2])
             {
-                global_window.scale *= 1.0f - 0.003f;
+                global_window.scale = fe_mul(global_window.scale, fe_from_double(1.0 - 0.003));
             }
             
             // see the above comment
             if(keys[KEY_MINUS1] || keys[KEY_MINUS2])
             {
-                global_window.scale *= 1.0f + 0.003f;
+                global_window.scale = fe_mul(global_window.scale, fe_from_double(1.0 + 0.003));
             }
             
             if (keys[KEY_W])
             {
-                global_window.pos[1] -= global_window.scale * 0.003f; 
+                global_window.offset[1] = fe_sub(global_window.offset[1], step);
             }
             
             if (keys[KEY_S])
             {
-                global_window.pos[1] += global_window.scale * 0.003f; 
+                global_window.offset[1] = fe_add(global_window.offset[1], step);
             }
             if (keys[KEY_A])
             {
-                global_window.pos[0] += global_window.scale * 0.003f; 
+                global_window.offset[0] = fe_add(global_window.offset[0], step);
             }
             
             if  (keys[KEY_D])
             {
-                global_window.pos[0] -= global_window.scale * 0.003f; 
+                global_window.offset[0] = fe_sub(global_window.offset[0], step);
             }
             
-            // if ctrl-r is pressed reset the scale and pos
+            // if ctrl-r is pressed reset the scale and pos, the offset goes to where it cancels
+            // the anchor and rebase_view folds it back in on the way
             if (keys[KEY_CTRL] && keys[KEY_R])
             {
-                global_window.pos[0] = 0.0f;
-                global_window.pos[1] = 0.0f;
-                global_window.scale = 1.0f;
+                for (int32_t i = 0; i < 2; ++i)
+                {
+                    FloatExp const anchor = fixed_to_floatexp(&global_window.anchor[i], FIXED_LIMBS);
+                    global_window.offset[i] = fe_sub(fe_from_double(0.0), anchor);
+                }
+                
+                global_window.scale = fe_from_double(1.0);
             }
             
             if (keys[KEY_UP])
@@ -326,6 +384,38 @@ __declspec(noreturn) void __stdcall entry(void)
             {
                 global_window.max_iterations -= 1;
             }
+            
+            // cycle through the shader variants, each is compiled the first time it is used.
+            // the precision starts out automatic and that comes again after the last one
+            {
+                Variant *const variant = &renderer.requested_variant;
+                if (pressed[KEY_F]) variant->formula = (variant->formula + 1) % FORMULA_LENGTH;
+                if (pressed[KEY_B]) variant->bailout = (variant->bailout + 1) % BAILOUT_LENGTH;
+                if (pressed[KEY_P])
+                {
+                    bool const automatic = renderer.automatic_precision;
+                    renderer.automatic_precision = !automatic && 
+                        variant->precision == PRECISION_LENGTH - 1;
+                    variant->precision = automatic ? 0 : (variant->precision + 1) % PRECISION_LENGTH;
+                }
+                if (pressed[KEY_C]) variant->coloring = (variant->coloring + 1) % COLORING_LENGTH;
+                if (pressed[KEY_U]) variant->unroll = (variant->unroll + 1) % UNROLL_LENGTH;
+                if (pressed[KEY_K]) variant->kernel = (variant->kernel + 1) % KERNEL_LENGTH;
+            }
+            
+            // only the keys we look at are cleared, a loop over all of them would become a
+            // memset call which we can not link without the crt
+            pressed[KEY_F] = pressed[KEY_B] = pressed[KEY_P] = pressed[KEY_C] = pressed[KEY_U] = false;
+            pressed[KEY_K] = false;
+        }
+        
+#ifdef PROFILE_MODE
+        if (drew_frame)
+        {
+            profile_phase(&profile, PHASE_INPUT);
+            profile_end_frame(&profile);
+            drew_frame = false;
         }
+#endif
     }
 }
@@ -3,15 +3,29 @@
 
 /* from http://dantefalcone.name/tutorials/1a-windows-win32-window-and-3d-context-creation/ */
 
+// the windowed build loads through wgl, the headless build through egl
+#ifdef _WIN32
+#define get_proc_address(name) wglGetProcAddress(name)
+#else
+#define get_proc_address(name) eglGetProcAddress(name)
+#endif
+
 // Program
 static PFNGLCREATEPROGRAMPROC glCreateProgram;
 static PFNGLUSEPROGRAMPROC glUseProgram;
 static PFNGLATTACHSHADERPROC glAttachShader;
 static PFNGLLINKPROGRAMPROC glLinkProgram;
+static PFNGLGETUNIFORMBLOCKINDEXPROC glGetUniformBlockIndex;
+static PFNGLUNIFORMBLOCKBINDINGPROC glUniformBlockBinding;
+static PFNGLDELETEPROGRAMPROC glDeleteProgram;
+static PFNGLGETPROGRAMIVPROC glGetProgramiv;
+static PFNGLPROGRAMPARAMETERIPROC glProgramParameteri;
+static PFNGLGETPROGRAMBINARYPROC glGetProgramBinary;
+static PFNGLPROGRAMBINARYPROC glProgramBinary;
 static PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
 static PFNGLUNIFORM1IPROC glUniform1i;
-static PFNGLUNIFORM1FPROC glUniform1f;
-static PFNGLUNIFORM4FPROC glUniform4f;
+static PFNGLUNIFORM2FPROC glUniform2f;
+static PFNGLUNIFORM4IPROC glUniform4i;
 
 // Shader
 static PFNGLCREATESHADERPROC glCreateShader;
@@ -19,30 +33,135 @@ static PFNGLSHADERSOURCEPROC glShaderSource;
 static PFNGLCOMPILESHADERPROC glCompileShader;
 
 // for debuging
+#ifdef DEBUG_MODE
 static PFNGLGETSHADERIVPROC glGetShaderiv;
 static PFNGLGETSHADERINFOLOGPROC glGetShaderInfoLog;
+#endif
+
+// Framebuffer
+static PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers;
+static PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer;
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer;
+static PFNGLGENRENDERBUFFERSPROC glGenRenderbuffers;
+static PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer;
+static PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage;
+static PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D;
+static PFNGLBLITFRAMEBUFFERPROC glBlitFramebuffer;
+static PFNGLDRAWBUFFERSPROC glDrawBuffers;
+
+// Texture, opengl32.dll only exports gl 1.1 while the linux gl.h already declares this
+#ifdef _WIN32
+static PFNGLACTIVETEXTUREPROC glActiveTexture;
+#endif
+
+// Texture buffer, holds the reference orbit for perturbation
+static PFNGLTEXBUFFERPROC glTexBuffer;
+
+// Compute, only called when a compute program linked
+static PFNGLDISPATCHCOMPUTEPROC glDispatchCompute;
+static PFNGLMEMORYBARRIERPROC glMemoryBarrier;
+static PFNGLBINDIMAGETEXTUREPROC glBindImageTexture;
+
+// Buffer
+static PFNGLGENBUFFERSPROC glGenBuffers;
+static PFNGLBINDBUFFERPROC glBindBuffer;
+static PFNGLBINDBUFFERBASEPROC glBindBufferBase;
+static PFNGLBUFFERDATAPROC glBufferData;
+static PFNGLBUFFERSUBDATAPROC glBufferSubData;
+
+// for frame capture
+#ifdef CAPTURE_MODE
+static PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
+static PFNGLUNMAPBUFFERPROC glUnmapBuffer;
+static PFNGLFENCESYNCPROC glFenceSync;
+static PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+static PFNGLDELETESYNCPROC glDeleteSync;
+#endif
 
-// we need to load opengl extensions from opengl32.dll
+// for profiling
+#ifdef PROFILE_MODE
+static PFNGLGENQUERIESPROC glGenQueries;
+static PFNGLBEGINQUERYPROC glBeginQuery;
+static PFNGLENDQUERYPROC glEndQuery;
+static PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv;
+static PFNGLGETQUERYOBJECTUIVPROC glGetQueryObjectuiv;
+#endif
+
+// we need to load opengl extensions from opengl32.dll (or libEGL when headless)
 static void load_extensions(void)
 {
     // Program
-    glCreateProgram = (PFNGLCREATEPROGRAMPROC)wglGetProcAddress("glCreateProgram");
-    glUseProgram = (PFNGLUSEPROGRAMPROC)wglGetProcAddress("glUseProgram");
-    glAttachShader = (PFNGLATTACHSHADERPROC)wglGetProcAddress("glAttachShader");
-    glLinkProgram = (PFNGLLINKPROGRAMPROC)wglGetProcAddress("glLinkProgram");
-    glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)wglGetProcAddress("glGetUniformLocation");
-    glUniform1i = (PFNGLUNIFORM1IPROC)wglGetProcAddress("glUniform1i");
-    glUniform1f = (PFNGLUNIFORM1FPROC)wglGetProcAddress("glUniform1f");
-    glUniform4f = (PFNGLUNIFORM4FPROC)wglGetProcAddress("glUniform4f");
+    glCreateProgram = (PFNGLCREATEPROGRAMPROC)get_proc_address("glCreateProgram");
+    glUseProgram = (PFNGLUSEPROGRAMPROC)get_proc_address("glUseProgram");
+    glAttachShader = (PFNGLATTACHSHADERPROC)get_proc_address("glAttachShader");
+    glLinkProgram = (PFNGLLINKPROGRAMPROC)get_proc_address("glLinkProgram");
+    glGetUniformBlockIndex = (PFNGLGETUNIFORMBLOCKINDEXPROC)get_proc_address("glGetUniformBlockIndex");
+    glUniformBlockBinding = (PFNGLUNIFORMBLOCKBINDINGPROC)get_proc_address("glUniformBlockBinding");
+    glDeleteProgram = (PFNGLDELETEPROGRAMPROC)get_proc_address("glDeleteProgram");
+    glGetProgramiv = (PFNGLGETPROGRAMIVPROC)get_proc_address("glGetProgramiv");
+    glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)get_proc_address("glProgramParameteri");
+    glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)get_proc_address("glGetProgramBinary");
+    glProgramBinary = (PFNGLPROGRAMBINARYPROC)get_proc_address("glProgramBinary");
+    glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC)get_proc_address("glGetUniformLocation");
+    glUniform1i = (PFNGLUNIFORM1IPROC)get_proc_address("glUniform1i");
+    glUniform2f = (PFNGLUNIFORM2FPROC)get_proc_address("glUniform2f");
+    glUniform4i = (PFNGLUNIFORM4IPROC)get_proc_address("glUniform4i");
     
     // Shader
-    glCreateShader = (PFNGLCREATESHADERPROC)wglGetProcAddress("glCreateShader");
-    glShaderSource = (PFNGLSHADERSOURCEPROC)wglGetProcAddress("glShaderSource");
-    glCompileShader = (PFNGLCOMPILESHADERPROC)wglGetProcAddress("glCompileShader");
+    glCreateShader = (PFNGLCREATESHADERPROC)get_proc_address("glCreateShader");
+    glShaderSource = (PFNGLSHADERSOURCEPROC)get_proc_address("glShaderSource");
+    glCompileShader = (PFNGLCOMPILESHADERPROC)get_proc_address("glCompileShader");
+    
+    // Framebuffer
+    glGenFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)get_proc_address("glGenFramebuffers");
+    glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)get_proc_address("glBindFramebuffer");
+    glFramebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)get_proc_address("glFramebufferRenderbuffer");
+    glGenRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)get_proc_address("glGenRenderbuffers");
+    glBindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)get_proc_address("glBindRenderbuffer");
+    glRenderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)get_proc_address("glRenderbufferStorage");
+    glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)get_proc_address("glFramebufferTexture2D");
+    glBlitFramebuffer = (PFNGLBLITFRAMEBUFFERPROC)get_proc_address("glBlitFramebuffer");
+    glDrawBuffers = (PFNGLDRAWBUFFERSPROC)get_proc_address("glDrawBuffers");
+    
+#ifdef _WIN32
+    // Texture
+    glActiveTexture = (PFNGLACTIVETEXTUREPROC)get_proc_address("glActiveTexture");
+#endif
+    
+    // Texture buffer
+    glTexBuffer = (PFNGLTEXBUFFERPROC)get_proc_address("glTexBuffer");
+    
+    // Compute
+    glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)get_proc_address("glDispatchCompute");
+    glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)get_proc_address("glMemoryBarrier");
+    glBindImageTexture = (PFNGLBINDIMAGETEXTUREPROC)get_proc_address("glBindImageTexture");
+    
+    // Buffer
+    glGenBuffers = (PFNGLGENBUFFERSPROC)get_proc_address("glGenBuffers");
+    glBindBuffer = (PFNGLBINDBUFFERPROC)get_proc_address("glBindBuffer");
+    glBindBufferBase = (PFNGLBINDBUFFERBASEPROC)get_proc_address("glBindBufferBase");
+    glBufferData = (PFNGLBUFFERDATAPROC)get_proc_address("glBufferData");
+    glBufferSubData = (PFNGLBUFFERSUBDATAPROC)get_proc_address("glBufferSubData");
     
 #ifdef DEBUG_MODE
-    glGetShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC)wglGetProcAddress("glGetShaderInfoLog");
-    glGetShaderiv = (PFNGLGETSHADERIVPROC)wglGetProcAddress("glGetShaderiv");
+    glGetShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC)get_proc_address("glGetShaderInfoLog");
+    glGetShaderiv = (PFNGLGETSHADERIVPROC)get_proc_address("glGetShaderiv");
+#endif
+    
+#ifdef CAPTURE_MODE
+    glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)get_proc_address("glMapBufferRange");
+    glUnmapBuffer = (PFNGLUNMAPBUFFERPROC)get_proc_address("glUnmapBuffer");
+    glFenceSync = (PFNGLFENCESYNCPROC)get_proc_address("glFenceSync");
+    glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)get_proc_address("glClientWaitSync");
+    glDeleteSync = (PFNGLDELETESYNCPROC)get_proc_address("glDeleteSync");
+#endif
+    
+#ifdef PROFILE_MODE
+    glGenQueries = (PFNGLGENQUERIESPROC)get_proc_address("glGenQueries");
+    glBeginQuery = (PFNGLBEGINQUERYPROC)get_proc_address("glBeginQuery");
+    glEndQuery = (PFNGLENDQUERYPROC)get_proc_address("glEndQuery");
+    glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)get_proc_address("glGetQueryObjectiv");
+    glGetQueryObjectuiv = (PFNGLGETQUERYOBJECTUIVPROC)get_proc_address("glGetQueryObjectuiv");
 #endif
 }
 
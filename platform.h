@@ -0,0 +1,192 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// the few os services shared by the windowed (win32, no crt) and headless (posix) builds
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+typedef HANDLE Semaphore;
+typedef HANDLE File;
+#else
+typedef sem_t Semaphore;
+typedef int File;
+#endif
+
+// write a null terminated string to stdout, only the shader log and the profile report do
+#if defined(DEBUG_MODE) || defined(PROFILE_MODE)
+static void print(char const *string)
+{
+#ifdef _WIN32
+    DWORD bytes_written;
+    WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), string, (DWORD)lstrlenA(string),
+              &bytes_written, NULL);
+#else
+    ssize_t const bytes_written = write(STDOUT_FILENO, string, strlen(string));
+    (void)bytes_written;
+#endif
+}
+#endif
+
+// a monotonic clock for measuring intervals
+static double seconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+// read up to capacity bytes of a file, returns the number of bytes read or 0 on failure
+static uint32_t read_file(char const *path, void *buffer, uint32_t capacity)
+{
+#ifdef _WIN32
+    HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return 0;
+    
+    DWORD bytes_read;
+    if (!ReadFile(file, buffer, capacity, &bytes_read, NULL)) bytes_read = 0;
+    CloseHandle(file);
+    
+    return bytes_read;
+#else
+    int const file = open(path, O_RDONLY);
+    if (file < 0) return 0;
+    
+    ssize_t const bytes_read = read(file, buffer, capacity);
+    close(file);
+    
+    return bytes_read > 0 ? (uint32_t)bytes_read : 0;
+#endif
+}
+
+// create or replace a file, returns false on failure
+static bool write_file(char const *path, void const *data, uint32_t size)
+{
+#ifdef _WIN32
+    HANDLE const file = CreateFileA(path, GENERIC_WRITE, 0, NULL,
+                                    CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    
+    DWORD bytes_written;
+    bool const success = WriteFile(file, data, size, &bytes_written, NULL) && 
+        bytes_written == size;
+    CloseHandle(file);
+    
+    return success;
+#else
+    int const file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) return false;
+    
+    bool const success = write(file, data, size) == (ssize_t)size;
+    return close(file) == 0 && success;
+#endif
+}
+
+// create or replace a file that is written in pieces, returns false on failure. only the
+// capture writes one
+#ifdef CAPTURE_MODE
+static bool create_file(File *file, char const *path)
+{
+#ifdef _WIN32
+    *file = CreateFileA(path, GENERIC_WRITE, 0, NULL,
+                        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return *file != INVALID_HANDLE_VALUE;
+#else
+    *file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return *file >= 0;
+#endif
+}
+
+// write to the end of a file from create_file, returns false on failure
+static bool append_file(File file, void const *data, uint32_t size)
+{
+#ifdef _WIN32
+    DWORD bytes_written;
+    return WriteFile(file, data, size, &bytes_written, NULL) && bytes_written == size;
+#else
+    return write(file, data, size) == (ssize_t)size;
+#endif
+}
+#endif
+
+static void create_semaphore(Semaphore *semaphore)
+{
+#ifdef _WIN32
+    *semaphore = CreateSemaphoreA(NULL, 0, 0x7FFFFFFF, NULL);
+#else
+    sem_init(semaphore, 0, 0);
+#endif
+}
+
+static void signal_semaphore(Semaphore *semaphore)
+{
+#ifdef _WIN32
+    ReleaseSemaphore(*semaphore, 1, NULL);
+#else
+    sem_post(semaphore);
+#endif
+}
+
+static void wait_semaphore(Semaphore *semaphore)
+{
+#ifdef _WIN32
+    WaitForSingleObject(*semaphore, INFINITE);
+#else
+    while (sem_wait(semaphore) != 0) {}
+#endif
+}
+
+// returns immediately, true if the semaphore was signaled
+static bool try_wait_semaphore(Semaphore *semaphore)
+{
+#ifdef _WIN32
+    return WaitForSingleObject(*semaphore, 0) == WAIT_OBJECT_0;
+#else
+    return sem_trywait(semaphore) == 0;
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI thread_entry(LPVOID function)
+{
+    ((void (*)(void))function)();
+    return 0;
+}
+#else
+static void *thread_entry(void *function)
+{
+    ((void (*)(void))function)();
+    return NULL;
+}
+#endif
+
+// the thread runs until the process exits
+static void start_thread(void (*function)(void))
+{
+#ifdef _WIN32
+    CreateThread(NULL, 0, &thread_entry, (LPVOID)function, 0, NULL);
+#else
+    // posix guarantees function pointers survive the trip through void * (see dlsym)
+    pthread_t thread;
+    pthread_create(&thread, NULL, &thread_entry, (void *)function);
+#endif
+}
+
+#endif // PLATFORM_H
@@ -0,0 +1,188 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+// cpu time per phase of a frame plus the gpu time of the draw, reported every
+// PROFILE_SAMPLES frames as min/avg/p99 in microseconds. the draws are also split up by the
+// precision that drew them, which changes with the zoom when it is picked automatically
+
+#define PROFILE_SAMPLES 256
+
+typedef enum Phase
+{
+    PHASE_EVENTS, // message processing since the last frame
+    PHASE_DRAW, // uniform upload and draw submission on the cpu
+    PHASE_SWAP,
+    PHASE_INPUT,
+    PHASE_GPU_DRAW, // measured with a timer query
+    PHASE_LENGTH
+} Phase;
+
+static char const *const phase_names[PHASE_LENGTH] = {
+    "events  ",
+    "draw    ",
+    "swap    ",
+    "input   ",
+    "gpu draw",
+};
+
+typedef struct Profile
+{
+    double phase_start;
+    int32_t samples[PHASE_LENGTH][PROFILE_SAMPLES];
+    int32_t sample_counts[PHASE_LENGTH];
+    Precision precisions[PROFILE_SAMPLES]; // of each draw sample
+    int32_t frame_count;
+    
+    // two queries so the result we read is always from two frames ago and never stalls
+    unsigned int queries[2];
+    bool query_used[2];
+} Profile;
+
+static void create_profile(Profile *profile)
+{
+    glGenQueries(2, profile->queries);
+    profile->phase_start = seconds();
+}
+
+static void add_sample(Profile *profile, Phase phase, int32_t microseconds)
+{
+    profile->samples[phase][profile->sample_counts[phase]++] = microseconds;
+}
+
+// ends the current phase and starts the next one
+static void profile_phase(Profile *profile, Phase phase)
+{
+    double const now = seconds();
+    add_sample(profile, phase, (int32_t)((now - profile->phase_start) * 1e6));
+    profile->phase_start = now;
+}
+
+// the precision the frame was drawn with, right after its draw phase ended
+static void profile_precision(Profile *profile, Precision precision)
+{
+    int32_t const count = profile->sample_counts[PHASE_DRAW];
+    if (count > 0) profile->precisions[count - 1] = precision;
+}
+
+static void profile_gpu_begin(Profile *profile)
+{
+    int32_t const query = profile->frame_count & 1;
+    
+    // collect the result from the last time this query was used if it is ready,
+    // otherwise the sample is dropped rather than waiting for it
+    if (profile->query_used[query])
+    {
+        int available;
+        glGetQueryObjectiv(profile->queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+        
+        if (available)
+        {
+            unsigned int nanoseconds;
+            glGetQueryObjectuiv(profile->queries[query], GL_QUERY_RESULT, &nanoseconds);
+            add_sample(profile, PHASE_GPU_DRAW, (int32_t)(nanoseconds / 1000));
+        }
+    }
+    
+    glBeginQuery(GL_TIME_ELAPSED, profile->queries[query]);
+    profile->query_used[query] = true;
+}
+
+static void profile_gpu_end(void)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+static char *append_string(char *out, char const *string)
+{
+    while (*string) *out++ = *string++;
+    return out;
+}
+
+static char *append_int(char *out, int32_t value)
+{
+    char digits[12];
+    int32_t count = 0;
+    
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    
+    while (count > 0) *out++ = digits[--count];
+    return out;
+}
+
+// prints the collected samples and starts over
+static void profile_report(Profile *profile)
+{
+    char report[(PHASE_LENGTH + PRECISION_LENGTH) * 64 + 1];
+    char *out = report;
+    
+    // before the draw samples are sorted and lose their precisions
+    int32_t precision_counts[PRECISION_LENGTH] = { 0 };
+    int32_t precision_sums[PRECISION_LENGTH] = { 0 };
+    for (int32_t i = 0; i < profile->sample_counts[PHASE_DRAW]; ++i)
+    {
+        precision_counts[profile->precisions[i]] += 1;
+        precision_sums[profile->precisions[i]] += profile->samples[PHASE_DRAW][i];
+    }
+    
+    for (int32_t phase = 0; phase < PHASE_LENGTH; ++phase)
+    {
+        int32_t *const samples = profile->samples[phase];
+        int32_t const count = profile->sample_counts[phase];
+        if (count == 0) continue;
+        
+        // insertion sort, there are only a few hundred samples
+        int32_t sum = 0;
+        for (int32_t i = 0; i < count; ++i)
+        {
+            int32_t const sample = samples[i];
+            int32_t j = i;
+            for (; j > 0 && samples[j - 1] > sample; --j) samples[j] = samples[j - 1];
+            samples[j] = sample;
+            sum += sample;
+        }
+        
+        out = append_string(out, phase_names[phase]);
+        out = append_string(out, " min ");
+        out = append_int(out, samples[0]);
+        out = append_string(out, " avg ");
+        out = append_int(out, sum / count);
+        out = append_string(out, " p99 ");
+        out = append_int(out, samples[(count * 99) / 100]);
+        out = append_string(out, " us\n");
+        
+        profile->sample_counts[phase] = 0;
+    }
+    
+    for (int32_t precision = 0; precision < PRECISION_LENGTH; ++precision)
+    {
+        int32_t const count = precision_counts[precision];
+        if (count == 0) continue;
+        
+        out = append_string(out, "draw as ");
+        out = append_string(out, precision_names[precision]);
+        out = append_string(out, " frames ");
+        out = append_int(out, count);
+        out = append_string(out, " avg ");
+        out = append_int(out, precision_sums[precision] / count);
+        out = append_string(out, " us\n");
+    }
+    
+    *out = '\0';
+    print(report);
+}
+
+static void profile_end_frame(Profile *profile)
+{
+    profile->frame_count += 1;
+    
+    if (profile->frame_count % PROFILE_SAMPLES == 0)
+    {
+        profile_report(profile);
+    }
+}
+
+#endif // PROFILE_H
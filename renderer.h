@@ -0,0 +1,1629 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+// everything needed to draw one frame, shared by the windowed and headless builds
+
+// the view is at anchor + offset, where pos is the negated centre like the c = uv*scale - pos
+// of the kernels. the anchor holds the bits a double runs out of on deep zooms and the offset
+// stays within a few scales of it, see rebase_view in the windowed build
+typedef struct Frame
+{
+    int32_t width, height;
+    float aspect_ratio;
+    float color_offset;
+    FloatExp scale;
+    Fixed const *anchor; // two of them, FIXED_LIMBS each
+    FloatExp offset[2];
+    int32_t max_iterations;
+} Frame;
+
+// field by field, a frame is too large to be copied without a memcpy call on 32 bit
+static void copy_frame(Frame *to, Frame const *from)
+{
+    to->width = from->width;
+    to->height = from->height;
+    to->aspect_ratio = from->aspect_ratio;
+    to->color_offset = from->color_offset;
+    to->scale = from->scale;
+    to->anchor = from->anchor;
+    to->offset[0] = from->offset[0];
+    to->offset[1] = from->offset[1];
+    to->max_iterations = from->max_iterations;
+}
+
+// matches the std140 layout of the uniform block U in ITERATE_SHADER_HEAD
+typedef struct Uniforms
+{
+    float D[4]; // color offset, scale and position
+    float A; // aspect ratio
+    int32_t I; // max iterations
+    int32_t R; // 1 to start from z = 0 instead of the previous state
+    float C; // D.yzw are divided by 2^C, only the floatexp kernel uses it
+    float H[4]; // what is left of D below float precision
+} Uniforms;
+
+// a cached program binary is stored after this header
+typedef struct ProgramCacheHeader
+{
+    uint32_t key;
+    uint32_t format;
+    uint32_t length;
+} ProgramCacheHeader;
+
+// big enough for any program binary we produce, larger ones are simply not cached
+static uint8_t program_cache[1 << 20];
+
+// a key only ever goes to one of PROGRAM_FILES files, trying out every variant and driver
+// update replaces old binaries instead of adding new ones. two programs in the same file
+// recompile each other, which is rare with this many for the few variants a session uses
+#define PROGRAM_FILES 64
+
+
+// by making this smaller we can save space at the cost of readabilty
+#define VERTEX_SHADER                                                                         \
+"#version 330\n"                                                                          \
+"out vec2 u;void main(){u=vec2[](vec2(0),vec2(1,0),vec2(0,1),vec2(1))[gl_VertexID];"      \
+"gl_Position=vec4(vec2[](vec2(-1,-1),vec2(1,-1),vec2(-1,1),vec2(1))[gl_VertexID],0,1);}"  \
+
+// the fragment shader is put together from these pieces, every variant gets its own
+// program so the kernel never branches on a setting that is constant for the frame
+typedef enum Formula
+{
+    FORMULA_MANDELBROT,
+    FORMULA_BURNING_SHIP,
+    FORMULA_TRICORN,
+    FORMULA_LENGTH
+} Formula;
+
+typedef enum Bailout
+{
+    BAILOUT_LARGE, // needed for smooth coloring
+    BAILOUT_SMALL, // escapes a few iterations earlier
+    BAILOUT_LENGTH
+} Bailout;
+
+typedef enum Precision
+{
+    PRECISION_FLOAT,
+    PRECISION_FLOAT_FLOAT, // two floats per number, about 48 bits
+    PRECISION_DOUBLE, // needs gl 4.0 or ARB_gpu_shader_fp64
+    PRECISION_PERTURBATION, // float offsets from a reference orbit computed in fixed point
+    PRECISION_FLOATEXP, // perturbation with an exponent per pixel, for views below float's range
+    PRECISION_LENGTH
+} Precision;
+
+// for the profile report, the headless build also prints one whenever the precision changes
+static char const *const precision_names[PRECISION_LENGTH] = {
+    "float",
+    "float-float",
+    "double",
+    "perturbation",
+    "floatexp",
+};
+
+typedef enum Coloring
+{
+    COLORING_SMOOTH,
+    COLORING_BANDED,
+    COLORING_LENGTH
+} Coloring;
+
+typedef enum Unroll
+{
+    UNROLL_1,
+    UNROLL_2,
+    UNROLL_4,
+    UNROLL_LENGTH
+} Unroll;
+
+typedef enum Kernel
+{
+    KERNEL_FRAGMENT, // a scissored quad per tile
+    KERNEL_COMPUTE, // persistent workgroups, needs gl 4.3
+    KERNEL_LENGTH
+} Kernel;
+
+typedef struct Variant
+{
+    Formula formula;
+    Bailout bailout;
+    Precision precision;
+    Coloring coloring;
+    Unroll unroll;
+    Kernel kernel;
+} Variant;
+
+#define VARIANT_COUNT (FORMULA_LENGTH * BAILOUT_LENGTH * PRECISION_LENGTH * COLORING_LENGTH * \
+                       UNROLL_LENGTH * KERNEL_LENGTH)
+
+// the #version line has to come first, the compute kernel always needs 4.3. float-float
+// only needs precise, which gpu_shader5 brings to 3.3 without fp64, and double is core in
+// 4.0 and gpu_shader_fp64 brings it to 3.3
+static char const *const version_sources[PRECISION_LENGTH] = {
+    "#version 330\n",
+    "#version 330\n#extension GL_ARB_gpu_shader5:enable\n",
+    "#version 330\n#extension GL_ARB_gpu_shader_fp64:enable\n",
+    "#version 330\n",
+    "#version 330\n",
+};
+
+#define COMPUTE_VERSION_SOURCE "#version 430\n"
+
+// what the kernels need from a precision: cc(u) is c for the pixel at u, jn(h,l) puts z
+// together from the high and low part kept in the state textures and hi(z), lo(z) split it
+// again, ad(a,b) adds and mg(z) is the squared magnitude compared against the bailout.
+// st(z,i) is the high part of the state as it is stored, with the iteration count
+#define NATIVE_PRECISION_SOURCE                                                           \
+"#define jn(h,l) (V(h)+V(l))\n#define ad(a,b) ((a)+(b))\n#define mg(z) dot(z,z)\n"        \
+"#define hi(z) vec2(z)\n#define lo(z) vec2((z)-V(vec2(z)))\n"                             \
+"#define st(z,i) vec4(hi(z),i,0)\n"                                                       \
+
+// float-float keeps every component as the unevaluated sum of two floats, z is (x high,
+// x low, y high, y low). fa adds and fm multiplies such pairs, precise keeps the compiler
+// from simplifying away the rounding errors they recover. a 3.3 driver without gpu_shader5
+// has no precise and is trusted not to simplify them. the error of a product comes from
+// splitting the factors in halves (sp), fma would be cheaper but is not always fused,
+// llvmpipe for one turns it into a multiply and an add
+#define FLOAT_FLOAT_PRECISION_SOURCE                                                      \
+"#define T float\n#define V vec4\n"                                                       \
+"#if __VERSION__<400&&!defined GL_ARB_gpu_shader5\n#define precise\n#endif\n"             \
+"vec2 fa(vec2 a,vec2 b){precise float s=a.x+b.x,v=s-a.x,"                                 \
+"e=(a.x-(s-v))+(b.x-v)+a.y+b.y,h=s+e;return vec2(h,e-(h-s));}\n"                          \
+"vec2 sp(float a){precise float t=a*4097,h=t-(t-a);return vec2(h,a-h);}\n"                \
+"vec2 fm(vec2 a,vec2 b){vec2 x=sp(a.x),y=sp(b.x);precise float p=a.x*b.x,"                \
+"e=((x.x*y.x-p)+x.x*y.y+x.y*y.x)+x.y*y.y+a.x*b.y+a.y*b.x,h=p+e;return vec2(h,e-(h-p));}\n" \
+"vec4 fc(vec2 t,vec2 s,vec4 p){return vec4(fa(fm(vec2(t.x,0),s),-p.xy),fa(fm(vec2(t.y,0),s),-p.zw));}\n" \
+"vec4 ad(vec4 a,vec4 b){return vec4(fa(a.xy,b.xy),fa(a.zw,b.zw));}\n"                     \
+"#define cc(u) fc((u*2-1)*vec2(A,1),vec2(D.y,H.y),vec4(D.z,H.z,D.w,H.w))\n"               \
+"#define jn(h,l) vec4((h).x,(l).x,(h).y,(l).y)\n#define mg(z) dot((z).xz,(z).xz)\n"       \
+"#define hi(z) (z).xz\n#define lo(z) (z).yw\n"                                            \
+"#define st(z,i) vec4(hi(z),i,0)\n"                                                       \
+
+// perturbation iterates the offset d of z from the reference orbit Z in the buffer texture
+// O, z is (d, index of Z, 0) and c the offset of the pixel's c from the reference's.
+// the high part of the state is the whole z for coloring, the low part d. the offset is
+// rebased onto the start of the orbit (rb) once z gets closer to 0 than d, or when the
+// orbit ends, which keeps it small enough for float without finding new references
+#define PERTURBATION_PRECISION_SOURCE                                                     \
+"#define V vec4\nuniform samplerBuffer O;\n#define rf(n) texelFetch(O,int(n)).xy\n"       \
+"vec2 cm(vec2 a,vec2 b){return vec2(a.x*b.x-a.y*b.y,a.x*b.y+a.y*b.x);}\n"                 \
+"vec4 rb(vec4 z){vec2 r=rf(z.z)+z.xy;"                                                    \
+"return z.z>=float(textureSize(O)-1)||dot(r,r)<dot(z.xy,z.xy)?vec4(r,0,0):z;}\n"          \
+"#define cc(u) vec4((u*2-1)*vec2(A,1)*D.y-D.zw,0,0)\n"                                    \
+"#define jn(h,l) vec4(l,(h).w,0)\n#define ad(a,b) rb((a)+(b))\n"                          \
+"#define mg(z) dot(hi(z),hi(z))\n"                                                        \
+"#define hi(z) (rf((z).z)+(z).xy)\n#define lo(z) (z).xy\n"                                \
+"#define st(z,i) vec4(hi(z),i,(z).z)\n"                                                   \
+
+// floatexp is perturbation with the offset kept as a mantissa and an exponent, z is
+// (m, index of Z, k) for an offset of m*2^k. c comes scaled by 2^C, C is 0 unless the view
+// is below float's range, and k starts there and is folded back towards 0 as soon as m
+// grows. sc(m,k) is m*2^k and leaves m alone when k is 0, with C at 0 this is the same math
+// as the perturbation kernel above. a zero offset never gets scaled up, 0*2^150 would be
+// inf*0. the high part of the state holds (k, 0) and the index as -1-index while k is not
+// 0, those pixels have not escaped
+#define FLOATEXP_PRECISION_SOURCE                                                         \
+"#define V vec4\nuniform samplerBuffer O;\n#define rf(n) texelFetch(O,int(n)).xy\n"       \
+"vec2 cm(vec2 a,vec2 b){return vec2(a.x*b.x-a.y*b.y,a.x*b.y+a.y*b.x);}\n"                 \
+"#define sc(m,k) ((k)==0?(m):(m)*exp2(k))\n"                                              \
+"vec4 rb(vec4 z){vec2 f=rf(z.z),n=z.xy+sc(sc(f,-.5*z.w),-.5*z.w);"                        \
+"return dot(n,n)<dot(z.xy,z.xy)?vec4(n,0,z.w):"                                           \
+"z.z>=float(textureSize(O)-1)?vec4(f+sc(z.xy,z.w),0,0):z;}\n"                             \
+"vec4 ad(vec4 a,vec4 b){float k=a.x==0&&a.y==0?b.w:max(a.w,b.w);"                         \
+"vec2 m=sc(a.xy,min(a.w-k,0))+sc(b.xy,b.w-k);"                                            \
+"if(k<0&&dot(m,m)>1){float f=max(k,-64.);m*=exp2(f);k-=f;}return rb(vec4(m,a.z,k));}\n"   \
+"#define cc(u) vec4((u*2-1)*vec2(A,1)*D.y-D.zw,0,C)\n"                                    \
+"#define jn(h,l) ((h).w<0?vec4(l,-1-(h).w,(h).x):vec4(l,(h).w,0))\n"                      \
+"#define mg(z) dot(hi(z),hi(z))\n"                                                        \
+"#define hi(z) (rf((z).z)+sc((z).xy,(z).w))\n#define lo(z) (z).xy\n"                      \
+"#define st(z,i) ((z).w<0?vec4((z).w,0,i,-1-(z).z):vec4(hi(z),i,(z).z))\n"                \
+
+// float only uses the high part of the view, double adds the low part back
+static char const *const precision_sources[PRECISION_LENGTH] = {
+    "#define T float\n#define V vec2\n#define cc(u) (V((u*2-1)*vec2(A,1))*T(D.y)-V(D.zw))\n"
+    NATIVE_PRECISION_SOURCE,
+    FLOAT_FLOAT_PRECISION_SOURCE,
+    "#define T double\n#define V dvec2\n"
+    "#define cc(u) (V((u*2-1)*vec2(A,1))*(T(D.y)+T(H.y))-(V(D.zw)+V(H.zw)))\n"
+    NATIVE_PRECISION_SOURCE,
+    PERTURBATION_PRECISION_SOURCE,
+    FLOATEXP_PRECISION_SOURCE,
+};
+
+// P(z) is z squared, or what the formula uses in its place
+static char const *const formula_sources[FORMULA_LENGTH] = {
+    "#define P(z) V(z.x*z.x-z.y*z.y,z.x*z.y*2)\n",
+    "#define P(z) V(z.x*z.x-z.y*z.y,abs(z.x*z.y)*2)\n",
+    "#define P(z) V(z.x*z.x-z.y*z.y,-z.x*z.y*2)\n",
+};
+
+static char const *const float_float_formula_sources[FORMULA_LENGTH] = {
+    "#define P(z) vec4(fa(fm(z.xy,z.xy),-fm(z.zw,z.zw)),fm(z.xy,z.zw)*2)\n",
+    "vec2 fb(vec2 a){return a.x<0?-a:a;}\n"
+    "#define P(z) vec4(fa(fm(z.xy,z.xy),-fm(z.zw,z.zw)),fb(fm(z.xy,z.zw))*2)\n",
+    "#define P(z) vec4(fa(fm(z.xy,z.xy),-fm(z.zw,z.zw)),-fm(z.xy,z.zw)*2)\n",
+};
+
+// with perturbation P(z) is how the formula moves the offset: (2Z+d)d for z squared. the
+// burning ship needs |xy|-|XY| without cancellation, fd(C,d) is |C+d|-|C|
+static char const *const perturbation_formula_sources[FORMULA_LENGTH] = {
+    "#define P(z) vec4(cm(2*rf(z.z)+z.xy,z.xy),z.z+1,0)\n",
+    "float fd(float c,float d){return c>=0?(c+d>=0?d:-2*c-d):(c+d>0?2*c+d:-d);}\n"
+    "vec4 P(vec4 z){vec2 r=rf(z.z),d=z.xy;return vec4((2*r.x+d.x)*d.x-(2*r.y+d.y)*d.y,"
+    "2*fd(r.x*r.y,r.x*d.y+r.y*d.x+d.x*d.y),z.z+1,0);}\n",
+    "#define P(z) vec4(cm(2*rf(z.z)+z.xy,z.xy)*vec2(1,-1),z.z+1,0)\n",
+};
+
+// the same on the mantissa, d*d picks up 2^k and the burning ship's |XY| is divided by it
+static char const *const floatexp_formula_sources[FORMULA_LENGTH] = {
+    "#define P(z) vec4(cm(2*rf(z.z)+sc(z.xy,z.w),z.xy),z.z+1,z.w)\n",
+    "float fd(float c,float d,float k){float q=c==0?0:sc(sc(c,-.5*k),-.5*k);"
+    "return c>=0?(q+d>=0?d:-2*q-d):(q+d>0?2*q+d:-d);}\n"
+    "vec4 P(vec4 z){vec2 r=rf(z.z),d=z.xy,s=sc(d,z.w);"
+    "return vec4((2*r.x+s.x)*d.x-(2*r.y+s.y)*d.y,"
+    "2*fd(r.x*r.y,r.x*d.y+r.y*d.x+s.x*d.y,z.w),z.z+1,z.w);}\n",
+    "#define P(z) vec4(cm(2*rf(z.z)+sc(z.xy,z.w),z.xy)*vec2(1,-1),z.z+1,z.w)\n",
+};
+
+static char const *const *const formula_tables[PRECISION_LENGTH] = {
+    formula_sources,
+    float_float_formula_sources,
+    formula_sources,
+    perturbation_formula_sources,
+    floatexp_formula_sources,
+};
+
+static char const *const bailout_sources[BAILOUT_LENGTH] = {
+    "#define B 200000.0\n",
+    "#define B 4.0\n",
+};
+
+// S(i,z) maps the escape iteration to the palette
+static char const *const coloring_sources[COLORING_LENGTH] = {
+    "#define S(i,z) sqrt((i-log2(log(float(dot(z,z)))/log(B)))/float(I))\n",
+    "#define S(i,z) sqrt(float(i)/float(I))\n",
+};
+
+static int32_t const unroll_factors[UNROLL_LENGTH] = { 1, 2, 4 };
+
+static char const *const unroll_sources[UNROLL_LENGTH] = {
+    "#define N 1\n",
+    "#define N 2\n",
+    "#define N 4\n",
+};
+
+// the iterate pass continues every pixel from the z and i stored in the Z (high part)
+// and L (low part, only non zero with more than float precision) state textures and
+// writes the new state. the main loop runs N steps per bounds check, the second loop
+// does the remainder
+#define ITERATE_SHADER_HEAD                                                   \
+"layout(location=0)out vec4 F;layout(location=1)out vec2 G;in vec2 u;"        \
+"layout(std140)uniform U{vec4 D;float A;int I;int R;float C;vec4 H;};"        \
+"uniform sampler2D Z,L;void main(){V c=cc(u);ivec2 p=ivec2(gl_FragCoord.xy);" \
+"vec4 s=R==0?texelFetch(Z,p,0):vec4(0);int i=int(s.z);"                       \
+"V z=jn(s,R==0?texelFetch(L,p,0).xy:vec2(0));"                                \
+"while(i+N<=I){"                                                              \
+
+#define ITERATE_SHADER_STEP                                                   \
+"if(mg(z)>=B)break;z=ad(P(z),c);++i;"                                         \
+
+#define ITERATE_SHADER_TAIL                                                   \
+"}for(;i<I&&mg(z)<B;++i)z=ad(P(z),c);"                                        \
+"F=st(z,i);G=lo(z);}"                                                         \
+
+// the compute kernel does the same work without a quad. every invocation pulls a pixel of
+// the rect Q (x, y, width, height) from the counter J and iterates it 32*N steps at a time,
+// when the pixel is done it stores the state and pulls the next one. invocations of a
+// group never wait for each other's pixels to escape, only for the rest of the steps.
+// the steps are unrolled and skipped once E is true, a loop that breaks out for some
+// lanes of a group left pixels unfinished on llvmpipe
+#define COMPUTE_GROUP_SIZE 64
+
+#define COMPUTE_SHADER_HEAD                                                   \
+"layout(local_size_x=64)in;layout(std430,binding=0)buffer W{uint J;};"        \
+"layout(std140)uniform U{vec4 D;float A;int I;int R;float C;vec4 H;};"        \
+"uniform sampler2D Z,L;layout(rgba32f,binding=0)writeonly uniform image2D X;" \
+"layout(rg32f,binding=1)writeonly uniform image2D Y;uniform ivec4 Q;\n"       \
+"#define E (i>=I||mg(z)>=B)\n#define M if(!E){z=ad(P(z),c);++i;}\n"           \
+"#define M8 M M M M M M M M\n"                                                \
+"void main(){int n=Q.z*Q.w,i;ivec2 p;V c,z;bool d=true;"                      \
+"for(;;){if(d){int k=int(atomicAdd(J,1u));if(k>=n)break;"                     \
+"p=Q.xy+ivec2(k%Q.z,k/Q.z);vec2 u=(vec2(p)+0.5)/vec2(imageSize(X));"          \
+"c=cc(u);vec4 s=R==0?texelFetch(Z,p,0):vec4(0);i=int(s.z);"                   \
+"z=jn(s,R==0?texelFetch(L,p,0).xy:vec2(0));}"                                 \
+
+#define COMPUTE_SHADER_STEP                                                   \
+"M8 M8 M8 M8 "                                                                \
+
+#define COMPUTE_SHADER_TAIL                                                   \
+"d=E;if(d){imageStore(X,p,st(z,i));"                                          \
+"imageStore(Y,p,vec4(lo(z),0,0));}}}"                                         \
+
+// the color pass turns a state texture into the image, K holds the color offset and the
+// iteration count the state was computed with
+#define COLOR_SHADER                                                          \
+"out vec4 F;uniform sampler2D Z;uniform vec2 K;"                              \
+"void main(){vec4 s=texelFetch(Z,ivec2(gl_FragCoord.xy),0);vec2 z=s.xy;"      \
+"int i=int(s.z);float I=K.y;"                                                 \
+"F=(sin(K.x+20*S(i,z)*vec4(1.5,1.8,2.1,0))*0.5+0.5)*float(i<I);}"             \
+
+#define SHADER_MAX_SOURCES 12
+
+// fills sources with the pieces of the iterate or color shader for a variant and returns
+// how many there are. the iterate shader is a compute shader for the compute kernel
+static int32_t shader_sources(Variant variant, bool color, char const *sources[SHADER_MAX_SOURCES])
+{
+    bool const compute = variant.kernel == KERNEL_COMPUTE && !color;
+    
+    int32_t count = 0;
+    sources[count++] = compute ? COMPUTE_VERSION_SOURCE : version_sources[variant.precision];
+    sources[count++] = precision_sources[variant.precision];
+    sources[count++] = formula_tables[variant.precision][variant.formula];
+    sources[count++] = bailout_sources[variant.bailout];
+    sources[count++] = coloring_sources[variant.coloring];
+    sources[count++] = unroll_sources[variant.unroll];
+    
+    if (color)
+    {
+        sources[count++] = COLOR_SHADER;
+        return count;
+    }
+    
+    sources[count++] = compute ? COMPUTE_SHADER_HEAD : ITERATE_SHADER_HEAD;
+    for (int32_t i = 0; i < unroll_factors[variant.unroll]; ++i)
+    {
+        sources[count++] = compute ? COMPUTE_SHADER_STEP : ITERATE_SHADER_STEP;
+    }
+    
+    sources[count++] = compute ? COMPUTE_SHADER_TAIL : ITERATE_SHADER_TAIL;
+    return count;
+}
+
+static uint32_t variant_index(Variant variant)
+{
+    uint32_t index = variant.formula;
+    index = index * BAILOUT_LENGTH + variant.bailout;
+    index = index * PRECISION_LENGTH + variant.precision;
+    index = index * COLORING_LENGTH + variant.coloring;
+    index = index * UNROLL_LENGTH + variant.unroll;
+    index = index * KERNEL_LENGTH + variant.kernel;
+    
+    return index;
+}
+
+// without a vertex shader the sources are compiled as a compute shader instead of a fragment shader
+static unsigned int compile_shaders(char const *vertex_shader_source,
+                                    int32_t shader_count,
+                                    char const *const *shader_sources)
+{
+    unsigned int shader_program = glCreateProgram();
+    
+    // compile vertex shader
+    if (vertex_shader_source)
+    {
+        unsigned int vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex_shader, 1, &vertex_shader_source, NULL);
+        glCompileShader(vertex_shader);
+        glAttachShader(shader_program, vertex_shader); 
+    }
+    
+    // compile fragment or compute shader
+    unsigned int shader = glCreateShader(vertex_shader_source ? GL_FRAGMENT_SHADER : GL_COMPUTE_SHADER);
+    glShaderSource(shader, shader_count, shader_sources, NULL);
+    glCompileShader(shader);
+    
+    // only needed for debugging
+#ifdef DEBUG_MODE
+    {
+        int success;
+        char info_log[512];
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        
+        if(success == GL_FALSE)
+        {
+            glGetShaderInfoLog(shader, sizeof(info_log), 
+                               NULL, info_log);
+            print(info_log);
+        }
+    }
+#endif
+    
+    // link the shaders
+    glAttachShader(shader_program, shader); 
+    glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(shader_program);
+    
+    return shader_program;
+}
+
+// fnv-1a, continuing from a previous hash
+static uint32_t hash_string(uint32_t hash, char const *string)
+{
+    while (*string)
+    {
+        hash = (hash ^ (uint8_t)*string++) * 16777619u;
+    }
+    
+    return hash;
+}
+
+// fnv-1a over data that is not a string
+static uint32_t hash_bytes(uint32_t hash, void const *data, uint32_t size)
+{
+    uint8_t const *const bytes = (uint8_t const *)data;
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    
+    return hash;
+}
+
+// the cache file name is a prefix and the key in hex so different programs (and reference
+// orbits) can be cached side by side. the prefix is at most 10 characters
+static void cache_path(char path[24], char const *prefix, uint32_t key)
+{
+    int32_t length = 0;
+    for (; prefix[length]; ++length) path[length] = prefix[length];
+    for (int32_t i = 0; i < 8; ++i) path[length + i] = "0123456789abcdef"[(key >> (28 - i * 4)) & 0xF];
+    
+    static char const suffix[] = ".bin";
+    for (int32_t i = 0; i < 5; ++i) path[length + 8 + i] = suffix[i];
+}
+
+// like compile_shaders, but reuses the driver's program binary from the last run when
+// the sources and the driver are unchanged, which skips compiling entirely
+static unsigned int load_program(char const *vertex_shader_source,
+                                 int32_t shader_count,
+                                 char const *const *shader_sources)
+{
+    // a binary is only valid for the driver that produced it
+    uint32_t key = 2166136261u;
+    if (vertex_shader_source) key = hash_string(key, vertex_shader_source);
+    for (int32_t i = 0; i < shader_count; ++i)
+    {
+        key = hash_string(key, shader_sources[i]);
+    }
+    
+    key = hash_string(key, (char const *)glGetString(GL_VENDOR));
+    key = hash_string(key, (char const *)glGetString(GL_RENDERER));
+    key = hash_string(key, (char const *)glGetString(GL_VERSION));
+    
+    char path[24];
+    cache_path(path, "program_", key % PROGRAM_FILES);
+    
+    ProgramCacheHeader *const header = (ProgramCacheHeader *)program_cache;
+    uint8_t *const binary = program_cache + sizeof(ProgramCacheHeader);
+    
+    uint32_t const size = read_file(path, program_cache, sizeof(program_cache));
+    if (size > sizeof(ProgramCacheHeader) && header->key == key && 
+        header->length == size - sizeof(ProgramCacheHeader))
+    {
+        unsigned int const shader_program = glCreateProgram();
+        glProgramBinary(shader_program, header->format, binary, (int)header->length);
+        
+        // the driver may still reject the binary, e.g. after an update with the same version string
+        int success;
+        glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
+        if (success == GL_TRUE) return shader_program;
+        
+        glDeleteProgram(shader_program);
+    }
+    
+    // fall back to compiling and store the result for the next run
+    unsigned int const shader_program = compile_shaders(vertex_shader_source,
+                                                        shader_count, shader_sources);
+    
+    int length = 0;
+    glGetProgramiv(shader_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length > 0 && length <= (int)(sizeof(program_cache) - sizeof(ProgramCacheHeader)))
+    {
+        GLenum format;
+        glGetProgramBinary(shader_program, length, &length, &format, binary);
+        
+        header->key = key;
+        header->format = format;
+        header->length = (uint32_t)length;
+        write_file(path, program_cache, sizeof(ProgramCacheHeader) + header->length);
+    }
+    
+    return shader_program;
+}
+
+typedef struct Programs
+{
+    unsigned int iterate;
+    unsigned int color;
+    int color_parameters; // location of K in the color program
+    bool compute; // iterate is a compute program
+    int rect; // location of Q in the compute program
+} Programs;
+
+// a failed variant (e.g. double precision without fp64 support) is remembered so it is not retried
+#define VARIANT_MISSING 0u
+#define VARIANT_FAILED 0xFFFFFFFFu
+
+static Programs variant_programs[VARIANT_COUNT];
+
+// set by the windowed or headless build when it has a second context sharing objects with
+// the rendering one, variants are then compiled on a thread without stalling the frame
+static bool (*make_compile_context_current)(void);
+
+// the compile thread works on one variant at a time
+static Semaphore compile_requested;
+static Semaphore compile_finished;
+static Variant compile_variant;
+static bool compiling;
+
+static unsigned int build_program(Variant variant, bool color)
+{
+    char const *sources[SHADER_MAX_SOURCES];
+    int32_t const count = shader_sources(variant, color, sources);
+    bool const compute = variant.kernel == KERNEL_COMPUTE && !color;
+    unsigned int const shader_program = load_program(compute ? NULL : VERTEX_SHADER, count, sources);
+    
+    int success;
+    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
+    if (success != GL_TRUE)
+    {
+        glDeleteProgram(shader_program);
+        return VARIANT_FAILED;
+    }
+    
+    return shader_program;
+}
+
+static Programs build_variant(Variant variant)
+{
+    Programs programs = { VARIANT_FAILED, VARIANT_FAILED, -1, false, -1 };
+    
+    unsigned int const iterate = build_program(variant, false);
+    unsigned int const color = build_program(variant, true);
+    if (iterate == VARIANT_FAILED || color == VARIANT_FAILED)
+    {
+        if (iterate != VARIANT_FAILED) glDeleteProgram(iterate);
+        if (color != VARIANT_FAILED) glDeleteProgram(color);
+        return programs;
+    }
+    
+    // the iterate program reads the per frame state from uniform buffer binding 0, the low
+    // part of the state from texture unit 1 and the reference orbit from texture unit 2,
+    // samplers default to unit 0
+    glUniformBlockBinding(iterate, glGetUniformBlockIndex(iterate, "U"), 0);
+    glUseProgram(iterate);
+    glUniform1i(glGetUniformLocation(iterate, "L"), 1);
+    glUniform1i(glGetUniformLocation(iterate, "O"), 2);
+    
+    programs.iterate = iterate;
+    programs.color = color;
+    programs.color_parameters = glGetUniformLocation(color, "K");
+    programs.compute = variant.kernel == KERNEL_COMPUTE;
+    programs.rect = glGetUniformLocation(iterate, "Q");
+    return programs;
+}
+
+static void compile_thread(void)
+{
+    make_compile_context_current();
+    
+    for (;;)
+    {
+        wait_semaphore(&compile_requested);
+        
+        Programs const programs = build_variant(compile_variant);
+        
+        // the programs have to be complete before the rendering context uses them
+        glFinish();
+        variant_programs[variant_index(compile_variant)] = programs;
+        
+        signal_semaphore(&compile_finished);
+    }
+}
+
+// the image is iterated in scissored tiles, as many tiles per frame as fit in the time
+// budget, so a deep render never turns into one draw long enough to trip the driver's
+// watchdog. a round of tiles always uses the frame it started with so an image spread
+// over several frames still comes out consistent
+#define TILE_COLUMNS 16
+#define TILE_ROWS 16
+#define TILE_COUNT (TILE_COLUMNS * TILE_ROWS)
+#define TIME_BUDGET 0.010 // seconds of drawing per frame
+
+// the compute kernel starts at most this many groups per rect, enough to fill a large gpu.
+// they stay until the rect is done instead of one group per block of pixels
+#define COMPUTE_GROUPS 128
+
+// while the view moves a round is iterated at a lower resolution, in steps of 1/16 of the
+// output size, so it still finishes within the time budget. the image is then scaled up to
+// the output. once the view stops moving the next round is back at full resolution
+#define RESOLUTION_STEPS 16
+#define MIN_RESOLUTION_STEPS 4
+
+// every pixel keeps its z and iteration count in a pair of state textures, one side of
+// the ping-pong holds the last complete state and the other is written by the current
+// round. when only max_iterations went up a round continues from the complete state
+// instead of iterating from z = 0 again
+typedef struct State
+{
+    unsigned int framebuffer;
+    unsigned int high_texture; // z rounded to float, iteration count
+    unsigned int low_texture; // the rest of z
+    
+    // where the state is colored when it is not at the output size
+    unsigned int color_framebuffer;
+    unsigned int color_renderbuffer;
+    int32_t width, height;
+} State;
+
+// the orbit of the view's centre (or of a point close to it) that perturbation iterates
+// the pixels' offsets against. it is computed in fixed point on the cpu and stored as
+// floats, a point is only needed to within the precision of the offsets but the orbit has
+// to be exact far below the scale or its errors grow into the pixels around it
+#define REFERENCE_CAPACITY (1 << 16) // the smallest buffer texture gl allows, longer orbits rebase
+#define REFERENCE_BAILOUT 200000.0 // the larger bailout so the orbit outlasts the pixels around it
+
+typedef struct Reference
+{
+    unsigned int buffer;
+    unsigned int texture;
+    Formula formula;
+    int32_t limbs; // the precision of the orbit, see reference_limbs
+    int32_t length; // points stored, 0 before the first orbit
+    int32_t saved_length; // points in its cache file
+    int32_t uploaded_length; // points in the buffer texture
+    bool escaped; // the orbit can not be extended any further
+} Reference;
+
+// a reference orbit as it is cached on disk, where the header is followed by as many points
+// as the orbit has. it is also where the orbit in use and its point are kept, so it is
+// written and read back as it is
+typedef struct ReferenceCache
+{
+    uint32_t key;
+    int32_t formula;
+    Fixed pos[2]; // the reference's c is -pos like the centre of a view
+    int32_t limbs;
+    int32_t length;
+    int32_t escaped;
+    Fixed z[2]; // the last point, to extend the orbit
+    float orbit[REFERENCE_CAPACITY * 2];
+} ReferenceCache;
+
+static ReferenceCache reference_cache;
+
+// orbits are written on a thread so a file of up to 512 kb does not stall the frame, and
+// reference_cache is left alone until it is done. a key only ever goes to one of
+// REFERENCE_FILES files, so a new orbit replaces an old one instead of filling the disk
+#define REFERENCE_FILES 16
+static Semaphore save_requested;
+static Semaphore save_finished;
+static bool save_started; // the thread is running
+static bool saving;
+static bool save_succeeded;
+
+typedef struct Renderer
+{
+    Programs programs;
+    unsigned int uniform_buffer;
+    unsigned int counter_buffer; // the next pixel for the compute kernel
+    Variant variant; // the variant of programs
+    Variant requested_variant; // drawn as soon as it is built
+    bool automatic_precision; // the precision follows the view, see pick_precision
+    Reference reference;
+    
+    State states[2];
+    int32_t complete_state; // index of the state the last complete round wrote
+    bool has_complete_state;
+    Frame complete_round; // the frame that state was iterated for
+    uint32_t complete_variant; // variant_index of the variant that iterated it
+    
+    // where the image is drawn to, 0 for the window, and its size
+    unsigned int output_framebuffer;
+    int32_t width, height;
+    
+    bool iterating; // a round of tiles is in progress
+    bool resuming; // it continues from the complete state
+    Frame round; // the frame the current round of tiles iterates
+    int32_t next_tile;
+    double tile_time; // estimated seconds per tile, used to size the batches
+    int32_t batch; // tiles in the last batch
+    double time_budget;
+    
+    Frame previous; // the last frame drawn, to tell whether the view is moving
+    int32_t round_steps; // resolution of the current round
+    double round_time; // seconds the current round has been iterated for so far
+    double pixel_time; // estimated seconds per pixel, used to pick the resolution
+    
+    // seconds per iteration the first whole round at full resolution of each precision took,
+    // 0 until there was one. see pick_precision
+    double precision_cost[PRECISION_LENGTH];
+} Renderer;
+
+static void create_renderer(Renderer *renderer, Variant variant)
+{
+    // the first variant is needed right away so it is built here
+    uint32_t const index = variant_index(variant);
+    variant_programs[index] = build_variant(variant);
+    
+    renderer->variant = variant;
+    renderer->requested_variant = variant;
+    renderer->programs = variant_programs[index];
+    
+    // the per frame state is uploaded as one block instead of looking up every uniform by name
+    glGenBuffers(1, &renderer->uniform_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, renderer->uniform_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Uniforms), NULL, GL_DYNAMIC_DRAW);
+    
+    glGenBuffers(1, &renderer->counter_buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, renderer->counter_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(uint32_t), NULL, GL_DYNAMIC_DRAW);
+    
+    // a buffer texture can not be empty, the first orbit replaces this point
+    glGenBuffers(1, &renderer->reference.buffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, renderer->reference.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, 2 * sizeof(float), reference_cache.orbit, GL_STATIC_DRAW);
+    glGenTextures(1, &renderer->reference.texture);
+    glBindTexture(GL_TEXTURE_BUFFER, renderer->reference.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, renderer->reference.buffer);
+    renderer->reference.length = 0;
+    renderer->reference.uploaded_length = 0;
+    
+    // the state textures are sized by the first round
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        State *const state = &renderer->states[i];
+        glGenTextures(1, &state->high_texture);
+        glGenTextures(1, &state->low_texture);
+        glGenFramebuffers(1, &state->framebuffer);
+        glGenRenderbuffers(1, &state->color_renderbuffer);
+        glGenFramebuffers(1, &state->color_framebuffer);
+        state->width = 0;
+        state->height = 0;
+        
+        // without mipmaps the default filter would leave the textures incomplete
+        unsigned int const textures[2] = { state->high_texture, state->low_texture };
+        for (int32_t j = 0; j < 2; ++j)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[j]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+    }
+    
+    renderer->complete_state = 0;
+    renderer->has_complete_state = false;
+    renderer->output_framebuffer = 0;
+    renderer->width = 0;
+    renderer->height = 0;
+    renderer->iterating = false;
+    renderer->resuming = false;
+    renderer->next_tile = 0;
+    renderer->tile_time = 0.0;
+    renderer->batch = 1;
+    renderer->time_budget = TIME_BUDGET;
+    renderer->automatic_precision = false;
+    renderer->previous.width = 0;
+    renderer->round_steps = RESOLUTION_STEPS;
+    renderer->round_time = 0.0;
+    renderer->pixel_time = 0.0;
+    for (int32_t i = 0; i < PRECISION_LENGTH; ++i) renderer->precision_cost[i] = 0.0;
+    
+    if (make_compile_context_current)
+    {
+        create_semaphore(&compile_requested);
+        create_semaphore(&compile_finished);
+        start_thread(&compile_thread);
+    }
+}
+
+// switches to the requested variant once it has been built, until then the current one is drawn.
+// returns true when it switched
+static bool update_variant(Renderer *renderer)
+{
+    if (compiling)
+    {
+        if (!try_wait_semaphore(&compile_finished)) return false;
+        compiling = false;
+    }
+    
+    uint32_t const index = variant_index(renderer->requested_variant);
+    Programs const programs = variant_programs[index];
+    
+    if (programs.iterate == VARIANT_FAILED)
+    {
+        renderer->requested_variant = renderer->variant;
+    }
+    
+    else if (programs.iterate == VARIANT_MISSING)
+    {
+        if (make_compile_context_current)
+        {
+            compile_variant = renderer->requested_variant;
+            compiling = true;
+            signal_semaphore(&compile_requested);
+        }
+        
+        else
+        {
+            variant_programs[index] = build_variant(renderer->requested_variant);
+        }
+    }
+    
+    else if (programs.iterate != renderer->programs.iterate)
+    {
+        renderer->variant = renderer->requested_variant;
+        renderer->programs = programs;
+        return true;
+    }
+    
+    return false;
+}
+
+static void resize_state(State *state, int32_t width, int32_t height)
+{
+    state->width = width;
+    state->height = height;
+    
+    glBindTexture(GL_TEXTURE_2D, state->high_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+    glBindTexture(GL_TEXTURE_2D, state->low_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, width, height, 0, GL_RG, GL_FLOAT, NULL);
+    
+    static GLenum const draw_buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glBindFramebuffer(GL_FRAMEBUFFER, state->framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 
+                           GL_TEXTURE_2D, state->high_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, 
+                           GL_TEXTURE_2D, state->low_texture, 0);
+    glDrawBuffers(2, draw_buffers);
+    
+    glBindRenderbuffer(GL_RENDERBUFFER, state->color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, state->color_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, 
+                              GL_RENDERBUFFER, state->color_renderbuffer);
+}
+
+typedef enum TileOperation
+{
+    TILE_DRAW, // a quad clipped to the tiles
+    TILE_DISPATCH, // the compute kernel over the tiles
+    TILE_BLIT, // scale the tiles of a state up to the output
+} TileOperation;
+
+static void draw_tile_rect(Renderer *renderer, State const *state, TileOperation operation,
+                           int32_t column, int32_t row, int32_t columns, int32_t rows)
+{
+    int32_t const x = column * state->width / TILE_COLUMNS;
+    int32_t const y = row * state->height / TILE_ROWS;
+    int32_t const next_x = (column + columns) * state->width / TILE_COLUMNS;
+    int32_t const next_y = (row + rows) * state->height / TILE_ROWS;
+    
+    if (operation == TILE_BLIT)
+    {
+        glBlitFramebuffer(x, y, next_x, next_y,
+                          column * renderer->width / TILE_COLUMNS,
+                          row * renderer->height / TILE_ROWS,
+                          (column + columns) * renderer->width / TILE_COLUMNS,
+                          (row + rows) * renderer->height / TILE_ROWS,
+                          GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        return;
+    }
+    
+    if (operation == TILE_DISPATCH)
+    {
+        // no more groups than there are pixels, the rest would find the counter used up
+        int32_t const pixels = (next_x - x) * (next_y - y);
+        int32_t groups = (pixels + COMPUTE_GROUP_SIZE - 1) / COMPUTE_GROUP_SIZE;
+        if (groups > COMPUTE_GROUPS) groups = COMPUTE_GROUPS;
+        if (groups == 0) return;
+        
+        static uint32_t const zero = 0;
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), &zero);
+        glUniform4i(renderer->programs.rect, x, y, next_x - x, next_y - y);
+        glDispatchCompute((unsigned int)groups, 1, 1);
+        
+        // the image stores have to land before the color pass or the next round reads them,
+        // or mean_iterations reads them back, and the counter before it is reset for the next rect
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT |
+                        GL_FRAMEBUFFER_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        return;
+    }
+    
+    // draw a quad, only the pixels inside the scissor rect are shaded
+    glScissor(x, y, next_x - x, next_y - y);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+// tiles go row by row so any run of them is at most three rects: the end of a row,
+// some full rows and the start of a row
+static void draw_tiles(Renderer *renderer, State const *state, TileOperation operation,
+                       int32_t first, int32_t count)
+{
+    int32_t const end = first + count;
+    while (first < end)
+    {
+        int32_t const column = first % TILE_COLUMNS;
+        int32_t const row = first / TILE_COLUMNS;
+        
+        if (column == 0 && end - first >= TILE_COLUMNS)
+        {
+            int32_t const rows = (end - first) / TILE_COLUMNS;
+            draw_tile_rect(renderer, state, operation, 0, row, TILE_COLUMNS, rows);
+            first += rows * TILE_COLUMNS;
+        }
+        
+        else
+        {
+            int32_t const columns = TILE_COLUMNS - column < end - first ? 
+                TILE_COLUMNS - column : end - first;
+            draw_tile_rect(renderer, state, operation, column, row, columns, 1);
+            first += columns;
+        }
+    }
+}
+
+// how many tiles fit in the given time, clamped before converting so it can not overflow
+static int32_t tiles_within(double time, double tile_time)
+{
+    double const tiles = time / tile_time;
+    return tiles < TILE_COUNT ? (int32_t)tiles : TILE_COUNT;
+}
+
+// a state can only be continued for exactly the same view. a moved anchor moves the offset
+// with it, so a view that was only rebased counts as a new one
+static bool same_view(Frame const *a, Frame const *b)
+{
+    return a->aspect_ratio == b->aspect_ratio && a->anchor == b->anchor &&
+        fe_equal(a->scale, b->scale) &&
+        fe_equal(a->offset[0], b->offset[0]) && fe_equal(a->offset[1], b->offset[1]);
+}
+
+static bool within(FloatExp a, FloatExp b, FloatExp distance)
+{
+    return fe_smaller(fe_sub(a, b), distance);
+}
+
+// the view is moving when it changed by at least half a pixel, the smoothing in the windowed
+// build takes a long time to settle on exactly the same values
+static bool view_moved(Frame const *previous, Frame const *frame)
+{
+    FloatExp const half_pixel = fe_mul(frame->scale, fe_from_double(1.0 / (double)frame->height));
+    return previous->width != frame->width || previous->height != frame->height ||
+        previous->anchor != frame->anchor ||
+        !within(previous->offset[0], frame->offset[0], half_pixel) ||
+        !within(previous->offset[1], frame->offset[1], half_pixel) ||
+        !within(previous->scale, frame->scale, half_pixel);
+}
+
+// the highest resolution whose round is expected to fit in the time budget. it goes up by
+// at most one step per round so it does not jump back and forth
+static int32_t moving_resolution(Renderer const *renderer, Frame const *frame)
+{
+    int32_t steps = renderer->round_steps + 1;
+    if (steps > RESOLUTION_STEPS) steps = RESOLUTION_STEPS;
+    if (renderer->pixel_time <= 0.0) return steps;
+    
+    for (; steps > MIN_RESOLUTION_STEPS; --steps)
+    {
+        double const width = (double)(frame->width * steps / RESOLUTION_STEPS);
+        double const height = (double)(frame->height * steps / RESOLUTION_STEPS);
+        if (width * height * renderer->pixel_time <= renderer->time_budget) break;
+    }
+    
+    return steps;
+}
+
+// below a scale of 2^-100 the floatexp kernel scales the view, float holds offsets down to
+// about 2^-126 and the pixels are a few more bits below the scale
+#define FLOATEXP_EXPONENT -100
+
+// the part of a double that float can not hold. the rounded value goes through a volatile
+// because gcc 12 vectorises two of these at -O2 and subtracts the unrounded value instead
+static float low_part(double value)
+{
+    float volatile const high = (float)value;
+    return (float)(value - (double)high);
+}
+
+// the limbs for an orbit good down to the scale: the integer limb, the bits above the scale,
+// float's 24 bits for the offsets below it and a limb to spare for the truncated products
+static int32_t reference_limbs(FloatExp scale)
+{
+    int32_t const bits = 24 - scale.exponent;
+    int32_t const limbs = 2 + (bits > 0 ? (bits + 31) / 32 : 0);
+    return limbs < FIXED_LIMBS ? limbs : FIXED_LIMBS;
+}
+
+// new references are the view's point with the bits below a quarter of the scale cleared,
+// so a view that comes back close to where it was picks the same point and finds its orbit
+// on disk
+static void reference_point(Fixed pos[2], Frame const *frame)
+{
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        fixed_from_floatexp(&pos[i], frame->offset[i], FIXED_LIMBS);
+        fixed_add(&pos[i], &frame->anchor[i], &pos[i], false, FIXED_LIMBS);
+        fixed_truncate(&pos[i], frame->scale.exponent - 2, FIXED_LIMBS);
+    }
+}
+
+// the view's pos relative to the reference's, exact in fixed point before it is rounded
+static void reference_offset(FloatExp offset[2], Frame const *frame)
+{
+    static Fixed difference;
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        fixed_add(&difference, &frame->anchor[i], &reference_cache.pos[i], true, FIXED_LIMBS);
+        offset[i] = fe_add(fixed_to_floatexp(&difference, FIXED_LIMBS), frame->offset[i]);
+    }
+}
+
+// the padding after the sign is left out
+static uint32_t reference_cache_key(Fixed const pos[2], Formula formula)
+{
+    uint32_t key = 2166136261u;
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        key = hash_bytes(key, pos[i].limbs, sizeof(pos[i].limbs));
+        key = hash_bytes(key, &pos[i].negative, sizeof(pos[i].negative));
+    }
+    
+    return hash_bytes(key, &formula, sizeof(formula));
+}
+
+static uint32_t reference_cache_size(int32_t length)
+{
+    uint32_t const header = (uint32_t)((uint8_t *)reference_cache.orbit - (uint8_t *)&reference_cache);
+    return header + (uint32_t)length * 2 * sizeof(float);
+}
+
+static bool same_point(Fixed const a[2], Fixed const b[2])
+{
+    uint32_t difference = 0;
+    for (int32_t i = 0; i < 2; ++i)
+    {
+        for (int32_t j = 0; j < FIXED_LIMBS; ++j) difference |= a[i].limbs[j] ^ b[i].limbs[j];
+        difference |= a[i].negative != b[i].negative;
+    }
+    
+    return difference == 0;
+}
+
+// looks for an orbit of the frame's reference point on disk. it is used when it has at least
+// the limbs the view needs, and extended from its last point like one computed in this run.
+// either way reference_cache.pos ends up holding the point
+static bool load_reference(Reference *reference, Frame const *frame, int32_t limbs)
+{
+    static Fixed pos[2];
+    reference_point(pos, frame);
+    
+    ReferenceCache const *const cache = &reference_cache;
+    uint32_t const key = reference_cache_key(pos, reference->formula);
+    char path[24];
+    cache_path(path, "reference_", key % REFERENCE_FILES);
+    
+    uint32_t const size = read_file(path, &reference_cache, sizeof(reference_cache));
+    if (size < reference_cache_size(0) || cache->key != key ||
+        cache->formula != (int32_t)reference->formula || !same_point(cache->pos, pos) ||
+        cache->limbs < limbs || cache->limbs > FIXED_LIMBS ||
+        cache->length < 1 || cache->length > REFERENCE_CAPACITY ||
+        size != reference_cache_size(cache->length))
+    {
+        // the file may have overwritten it
+        reference_point(reference_cache.pos, frame);
+        return false;
+    }
+    
+    reference->limbs = cache->limbs;
+    reference->length = cache->length;
+    reference->saved_length = cache->length;
+    reference->escaped = cache->escaped != 0;
+    return true;
+}
+
+static void save_thread(void)
+{
+    for (;;)
+    {
+        wait_semaphore(&save_requested);
+        
+        ReferenceCache const *const cache = &reference_cache;
+        char path[24];
+        cache_path(path, "reference_", cache->key % REFERENCE_FILES);
+        save_succeeded = write_file(path, cache, reference_cache_size(cache->length));
+        
+        signal_semaphore(&save_finished);
+    }
+}
+
+static void save_reference(Reference *reference)
+{
+    ReferenceCache *const cache = &reference_cache;
+    cache->key = reference_cache_key(cache->pos, reference->formula);
+    cache->formula = (int32_t)reference->formula;
+    cache->limbs = reference->limbs;
+    cache->length = reference->length;
+    cache->escaped = reference->escaped;
+    
+    if (!save_started)
+    {
+        create_semaphore(&save_requested);
+        create_semaphore(&save_finished);
+        start_thread(&save_thread);
+        save_started = true;
+    }
+    
+    saving = true;
+    signal_semaphore(&save_requested);
+}
+
+// waits for an orbit that is still being written, call before exiting
+static void finish_saving(void)
+{
+    if (!saving) return;
+    wait_semaphore(&save_finished);
+    saving = false;
+}
+
+// returns false while the orbit is still being written
+static bool reference_saved(Reference *reference)
+{
+    if (!saving) return true;
+    if (!try_wait_semaphore(&save_finished)) return false;
+    
+    saving = false;
+    if (save_succeeded) reference->saved_length = reference_cache.length;
+    return true;
+}
+
+// z = z^2 + c with three squares and no general product, 2xy is (x + y)^2 - x^2 - y^2.
+// c is -pos
+static void reference_step(Fixed z[2], Fixed const pos[2], Formula formula, int32_t limbs)
+{
+    static Fixed xx, yy, xy;
+    
+    // the burning ship takes the product of the magnitudes, the squares do not mind the signs
+    if (formula == FORMULA_BURNING_SHIP) z[0].negative = z[1].negative = false;
+    fixed_add(&xy, &z[0], &z[1], false, limbs);
+    
+    Fixed *const squares[3] = { &xx, &yy, &xy };
+    Fixed const *const values[3] = { &z[0], &z[1], &xy };
+    fixed_square_3(squares, values, limbs);
+    fixed_add(&xy, &xy, &xx, true, limbs);
+    fixed_add(&xy, &xy, &yy, true, limbs);
+    if (formula == FORMULA_TRICORN) xy.negative = !xy.negative;
+    
+    fixed_add(&z[0], &xx, &yy, true, limbs);
+    fixed_add(&z[0], &z[0], &pos[0], true, limbs);
+    fixed_add(&z[1], &xy, &pos[1], true, limbs);
+}
+
+// makes sure the reference orbit is good for the frame, and returns false while it is not
+// yet. an orbit is kept as long as its point stays in view, so it is not recomputed while
+// moving around or zooming into it, and it is only extended when the iteration count goes
+// up. zooming in far enough that the orbit needs more limbs starts it over. the points are
+// computed until the deadline and a long orbit takes as many frames as it needs, it is only
+// uploaded once it is done. orbits are cached on disk, a new one is written the first time
+// and again whenever it grew by a quarter
+static bool update_reference(Reference *reference, Formula formula, Frame const *frame,
+                             double deadline)
+{
+    int32_t const limbs = reference_limbs(frame->scale);
+    FloatExp offset[2];
+    reference_offset(offset, frame);
+    bool const stale = reference->length == 0 || reference->formula != formula ||
+        reference->limbs < limbs ||
+        !fe_smaller(offset[0], frame->scale) || !fe_smaller(offset[1], frame->scale);
+    
+    // an orbit is only written once it is uploaded, so while it is the uploaded one is still
+    // good unless the frame needs another or a longer one
+    if (!reference_saved(reference))
+    {
+        return !stale && (reference->escaped || reference->length > frame->max_iterations ||
+                          reference->length == REFERENCE_CAPACITY);
+    }
+    
+    if (stale)
+    {
+        reference->formula = formula;
+        reference->uploaded_length = 0;
+        if (!load_reference(reference, frame, limbs))
+        {
+            reference->limbs = limbs;
+            fixed_from_double(&reference_cache.z[0], 0.0, limbs);
+            fixed_from_double(&reference_cache.z[1], 0.0, limbs);
+            reference_cache.orbit[0] = 0.0f;
+            reference_cache.orbit[1] = 0.0f;
+            reference->length = 1;
+            reference->saved_length = 0;
+            reference->escaped = false;
+        }
+    }
+    
+    // the clock is only read every 64 points, a shallow step takes less time than reading it
+    int32_t length = reference->length;
+    while (!reference->escaped && length <= frame->max_iterations && length < REFERENCE_CAPACITY)
+    {
+        reference_step(reference_cache.z, reference_cache.pos, formula, reference->limbs);
+        double const x = fixed_to_double(&reference_cache.z[0], reference->limbs);
+        double const y = fixed_to_double(&reference_cache.z[1], reference->limbs);
+        
+        reference_cache.orbit[length * 2] = (float)x;
+        reference_cache.orbit[length * 2 + 1] = (float)y;
+        ++length;
+        
+        if (x * x + y * y >= REFERENCE_BAILOUT) reference->escaped = true;
+        if (length % 64 == 0 && seconds() >= deadline) break;
+    }
+    
+    reference->length = length;
+    bool const done = reference->escaped || length > frame->max_iterations ||
+                      length == REFERENCE_CAPACITY;
+    if (!done || length == reference->uploaded_length) return done;
+    
+    if (length - reference->saved_length > reference->saved_length / 4) save_reference(reference);
+    
+    glBindBuffer(GL_TEXTURE_BUFFER, reference->buffer);
+    glBufferData(GL_TEXTURE_BUFFER, length * 2 * (int32_t)sizeof(float), reference_cache.orbit,
+                 GL_STATIC_DRAW);
+    reference->uploaded_length = length;
+    return true;
+}
+
+// the bits between the view's magnitude and a pixel each precision resolves, a few less than
+// its mantissa for the error the iterations add. past double perturbation takes over, and
+// below FLOATEXP_EXPONENT floatexp
+static int32_t const precision_bits[PRECISION_DOUBLE + 1] = { 20, 44, 49 };
+
+// the cheapest precision that still resolves the pixels of the view. one below the current
+// precision needs two more bits to spare so a view at the edge does not switch back and forth,
+// and so does leaving floatexp. a precision that failed to build is skipped for the next one up.
+// float-float emulates double with several floats and is the slower one where fp64 is fast,
+// e.g. on llvmpipe, so once it has a measured cost double is measured as well and takes over
+// if it is cheaper. each is only measured once, so the choice does not flip back and forth
+// with the views they happened to be measured on
+static Precision pick_precision(Renderer const *renderer, Frame const *frame)
+{
+    FloatExp const x = fe_add(fixed_to_floatexp(&frame->anchor[0], FIXED_LIMBS), frame->offset[0]);
+    FloatExp const y = fe_add(fixed_to_floatexp(&frame->anchor[1], FIXED_LIMBS), frame->offset[1]);
+    FloatExp larger = fe_smaller(x, y) ? y : x;
+    if (larger.mantissa < 0.0) larger.mantissa = -larger.mantissa;
+    FloatExp const extent = fe_mul(frame->scale, fe_from_double(frame->aspect_ratio));
+    FloatExp const magnitude = fe_add(larger, extent);
+    FloatExp const pixel = fe_mul(frame->scale, fe_from_double(2.0 / (double)frame->height));
+    int32_t const bits = magnitude.exponent - pixel.exponent;
+    
+    Precision const current = renderer->variant.precision;
+    int32_t const floatexp_exponent = FLOATEXP_EXPONENT + (current == PRECISION_FLOATEXP ? 2 : 0);
+    Precision precision = frame->scale.exponent < floatexp_exponent ?
+        PRECISION_FLOATEXP : PRECISION_PERTURBATION;
+    for (int32_t i = PRECISION_DOUBLE; i >= 0; --i)
+    {
+        if (bits + ((Precision)i < current ? 2 : 0) <= precision_bits[i]) precision = (Precision)i;
+    }
+    
+    Variant variant = renderer->requested_variant;
+    for (; precision < PRECISION_LENGTH - 1; precision = (Precision)(precision + 1))
+    {
+        variant.precision = precision;
+        if (variant_programs[variant_index(variant)].iterate != VARIANT_FAILED) break;
+    }
+    
+    if (precision == PRECISION_FLOAT_FLOAT)
+    {
+        double const float_float = renderer->precision_cost[PRECISION_FLOAT_FLOAT];
+        double const fp64 = renderer->precision_cost[PRECISION_DOUBLE];
+        variant.precision = PRECISION_DOUBLE;
+        if (variant_programs[variant_index(variant)].iterate != VARIANT_FAILED &&
+            float_float > 0.0 && (fp64 == 0.0 || fp64 < float_float))
+        {
+            precision = PRECISION_DOUBLE;
+        }
+    }
+    
+    return precision;
+}
+
+static bool uses_reference(Precision precision)
+{
+    return precision == PRECISION_PERTURBATION || precision == PRECISION_FLOATEXP;
+}
+
+// the reference orbit must be up to date for the frame, see update_reference
+static void start_round(Renderer *renderer, Frame const *frame)
+{
+    copy_frame(&renderer->round, frame);
+    renderer->iterating = true;
+    renderer->next_tile = 0;
+    renderer->round_time = 0.0;
+    
+    // perturbation passes the view relative to the reference, which is small enough for float
+    Precision const precision = renderer->variant.precision;
+    FloatExp view_pos[2];
+    if (uses_reference(precision))
+    {
+        reference_offset(view_pos, frame);
+    }
+    
+    else
+    {
+        view_pos[0] = fe_add(fixed_to_floatexp(&frame->anchor[0], FIXED_LIMBS), frame->offset[0]);
+        view_pos[1] = fe_add(fixed_to_floatexp(&frame->anchor[1], FIXED_LIMBS), frame->offset[1]);
+    }
+    
+    // floatexp gets the view divided by 2^C once the scale leaves float's range, and the
+    // same values as perturbation before that
+    int32_t exponent = 0;
+    if (precision == PRECISION_FLOATEXP && frame->scale.exponent < FLOATEXP_EXPONENT)
+    {
+        exponent = frame->scale.exponent;
+    }
+    
+    double const scale = fe_ldexp(frame->scale.mantissa, frame->scale.exponent - exponent);
+    double const pos[2] = {
+        fe_ldexp(view_pos[0].mantissa, view_pos[0].exponent - exponent),
+        fe_ldexp(view_pos[1].mantissa, view_pos[1].exponent - exponent),
+    };
+    
+    // pass uniforms
+    Uniforms const uniforms = {
+        .D = { frame->color_offset, (float)scale, (float)pos[0], (float)pos[1] },
+        .A = frame->aspect_ratio,
+        .I = frame->max_iterations,
+        .R = !renderer->resuming,
+        .C = (float)exponent,
+        .H = { 0.0f, low_part(scale), low_part(pos[0]), low_part(pos[1]) },
+    };
+    
+    glBindBuffer(GL_UNIFORM_BUFFER, renderer->uniform_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(uniforms), &uniforms);
+}
+
+// the mean iteration count of a round, read back from the state a band of rows at a time.
+// the count is the blue channel of the high part, for every variant
+static double mean_iterations(State const *state)
+{
+    static float iterations[1 << 16];
+    int32_t const rows = (int32_t)(sizeof(iterations) / sizeof(*iterations)) / state->width;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, state->framebuffer);
+    
+    double sum = 0.0;
+    for (int32_t y = 0; y < state->height; y += rows)
+    {
+        int32_t const count = state->height - y < rows ? state->height - y : rows;
+        glReadPixels(0, y, state->width, count, GL_BLUE, GL_FLOAT, iterations);
+        for (int32_t i = 0; i < state->width * count; ++i) sum += iterations[i];
+    }
+    
+    return sum / ((double)state->width * (double)state->height);
+}
+
+// draws tiles until the deadline, at least one batch
+static void iterate_tiles(Renderer *renderer, double deadline)
+{
+    State const *const source = &renderer->states[renderer->complete_state];
+    State const *const target = &renderer->states[!renderer->complete_state];
+    
+    glUseProgram(renderer->programs.iterate);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, renderer->uniform_buffer);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, renderer->reference.texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, source->low_texture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, source->high_texture);
+    
+    TileOperation const operation = renderer->programs.compute ? TILE_DISPATCH : TILE_DRAW;
+    if (operation == TILE_DISPATCH)
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, renderer->counter_buffer);
+        glBindImageTexture(0, target->high_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+        glBindImageTexture(1, target->low_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+    }
+    
+    else
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, target->framebuffer);
+        glViewport(0, 0, target->width, target->height);
+        glEnable(GL_SCISSOR_TEST);
+    }
+    
+    // draw tiles in batches sized from the time the previous ones took, waiting for each
+    // batch to finish keeps the gpu queue short so the budget is actually respected.
+    // batches at most double in size since the next tiles may be much more expensive
+    double const begin = seconds();
+    double now = begin;
+    
+    do
+    {
+        int32_t const fit = renderer->tile_time > 0.0 ? 
+            tiles_within(deadline - now, renderer->tile_time) : 1;
+        int32_t const remaining = TILE_COUNT - renderer->next_tile;
+        
+        int32_t batch = renderer->batch * 2;
+        if (batch > fit) batch = fit;
+        if (batch > remaining) batch = remaining;
+        if (batch < 1) batch = 1;
+        
+        double const start = now;
+        draw_tiles(renderer, target, operation, renderer->next_tile, batch);
+        renderer->next_tile += batch;
+        
+        glFinish();
+        now = seconds();
+        renderer->tile_time = (now - start) / batch;
+        renderer->batch = batch;
+    } while (renderer->next_tile < TILE_COUNT && now < deadline);
+    
+    glDisable(GL_SCISSOR_TEST);
+    
+    // the cost of a pixel so far decides the resolution of the next round while moving
+    renderer->round_time += now - begin;
+    double const pixels = (double)target->width * (double)target->height;
+    renderer->pixel_time = renderer->round_time * TILE_COUNT / (pixels * renderer->next_tile);
+    
+    // the round is done, its state becomes the complete one. the cost is taken from a round
+    // that iterated every pixel from the start, reduced resolutions spend more on overhead
+    if (renderer->next_tile == TILE_COUNT)
+    {
+        renderer->complete_state = !renderer->complete_state;
+        renderer->has_complete_state = true;
+        copy_frame(&renderer->complete_round, &renderer->round);
+        renderer->complete_variant = variant_index(renderer->variant);
+        renderer->iterating = false;
+        
+        double *const cost = &renderer->precision_cost[renderer->variant.precision];
+        if (*cost == 0.0 && !renderer->resuming && renderer->round_steps == RESOLUTION_STEPS)
+        {
+            double const iterations = mean_iterations(target);
+            if (iterations > 0.0) *cost = renderer->round_time / (pixels * iterations);
+        }
+    }
+}
+
+static bool at_output_size(Renderer const *renderer, State const *state)
+{
+    return state->width == renderer->width && state->height == renderer->height;
+}
+
+// colors straight into the output when the state has its size, otherwise the tiles are
+// colored at the state's size and then scaled up
+static void color_tiles(Renderer *renderer, State const *state, bool direct, 
+                        int32_t max_iterations, float color_offset, int32_t first, int32_t count)
+{
+    if (count == 0) return;
+    
+    glBindTexture(GL_TEXTURE_2D, state->high_texture);
+    glUniform2f(renderer->programs.color_parameters, color_offset, (float)max_iterations);
+    
+    if (direct)
+    {
+        draw_tiles(renderer, state, TILE_DRAW, first, count);
+        return;
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, state->color_framebuffer);
+    glViewport(0, 0, state->width, state->height);
+    glEnable(GL_SCISSOR_TEST);
+    draw_tiles(renderer, state, TILE_DRAW, first, count);
+    
+    // the scissor test applies to blits as well
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, state->color_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, renderer->output_framebuffer);
+    draw_tiles(renderer, state, TILE_BLIT, first, count);
+}
+
+static void draw_frame(Renderer *renderer, Frame const *frame)
+{
+    // nothing to draw while minimized
+    if (frame->width <= 0 || frame->height <= 0) return;
+    
+    // the reference orbit and the tiles share the time budget
+    double const deadline = seconds() + renderer->time_budget;
+    
+    if (renderer->automatic_precision)
+    {
+        renderer->requested_variant.precision = pick_precision(renderer, frame);
+    }
+    
+    // a round is only valid for the variant it was iterated with. the complete state can
+    // not be continued by another variant either, but it still shows until the next round
+    // replaces it since every variant stores escaped pixels the same way
+    if (update_variant(renderer))
+    {
+        renderer->iterating = false;
+    }
+    
+    renderer->width = frame->width;
+    renderer->height = frame->height;
+    
+    // a round still iterating an old view is dropped while the view moves, so the next one
+    // starts right away at a lower resolution. at the lowest resolution it is finished instead
+    // so there is always progress
+    bool const moving = view_moved(&renderer->previous, frame);
+    copy_frame(&renderer->previous, frame);
+    if (moving && renderer->iterating && renderer->round_steps > MIN_RESOLUTION_STEPS)
+    {
+        renderer->iterating = false;
+    }
+    
+    if (!renderer->iterating)
+    {
+        int32_t const steps = moving ? moving_resolution(renderer, frame) : RESOLUTION_STEPS;
+        int32_t width = frame->width * steps / RESOLUTION_STEPS;
+        int32_t height = frame->height * steps / RESOLUTION_STEPS;
+        if (width < 1) width = 1;
+        if (height < 1) height = 1;
+        
+        // continue from the complete state when only the iteration count went up,
+        // and when nothing changed there is nothing to iterate at all
+        State *const complete_state = &renderer->states[renderer->complete_state];
+        Frame const *const complete = &renderer->complete_round;
+        renderer->resuming = renderer->has_complete_state &&
+            renderer->complete_variant == variant_index(renderer->variant) &&
+            same_view(complete, frame) &&
+            frame->max_iterations >= complete->max_iterations &&
+            complete_state->width == width && complete_state->height == height;
+        
+        if (!renderer->resuming || frame->max_iterations != complete->max_iterations)
+        {
+            // the state a round writes has the round's resolution, the complete state keeps
+            // its own until the round replaces it
+            State *const target = &renderer->states[!renderer->complete_state];
+            if (target->width != width || target->height != height)
+            {
+                resize_state(target, width, height);
+            }
+            
+            // tiles at another resolution take another time to iterate
+            if (steps != renderer->round_steps)
+            {
+                renderer->tile_time = renderer->pixel_time * (double)width * (double)height / TILE_COUNT;
+            }
+            
+            // perturbation waits for its reference orbit, which may take several frames, and
+            // the complete state is shown until then
+            if (!uses_reference(renderer->variant.precision) ||
+                update_reference(&renderer->reference, renderer->variant.formula, frame, deadline))
+            {
+                renderer->round_steps = steps;
+                start_round(renderer, frame);
+            }
+        }
+    }
+    
+    if (renderer->iterating) iterate_tiles(renderer, deadline);
+    
+    // color the tiles this round has finished from its state and the rest from the complete one
+    State const *const round_state = &renderer->states[!renderer->complete_state];
+    State const *const complete_state = &renderer->states[renderer->complete_state];
+    int32_t const finished = renderer->iterating ? renderer->next_tile : 0;
+    bool const direct = (finished == 0 || at_output_size(renderer, round_state)) &&
+        (!renderer->has_complete_state || at_output_size(renderer, complete_state));
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer->output_framebuffer);
+    glViewport(0, 0, renderer->width, renderer->height);
+    glUseProgram(renderer->programs.color);
+    
+    if (!renderer->has_complete_state)
+    {
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    
+    if (direct) glEnable(GL_SCISSOR_TEST);
+    
+    color_tiles(renderer, round_state, direct, renderer->round.max_iterations, 
+                frame->color_offset, 0, finished);
+    
+    if (renderer->has_complete_state)
+    {
+        color_tiles(renderer, complete_state, direct, renderer->complete_round.max_iterations, 
+                    frame->color_offset, finished, TILE_COUNT - finished);
+    }
+    
+    glDisable(GL_SCISSOR_TEST);
+}
+
+#endif // RENDERER_H